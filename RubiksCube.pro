@@ -1,16 +1,22 @@
-QT       += core gui opengl openglwidgets
+QT       += core gui opengl openglwidgets concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+include(cubecore.pri)
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
     cubegeometry.cpp \
+    cuberenderer.cpp \
+    cubescene.cpp \
+    frameprofiler.cpp \
     history.cpp \
+    historymodel.cpp \
     main.cpp \
     mainwindow.cpp \
     openglwidget.cpp \
@@ -19,7 +25,11 @@ SOURCES += \
 
 HEADERS += \
     cubegeometry.h \
+    cuberenderer.h \
+    cubescene.h \
+    frameprofiler.h \
     history.h \
+    historymodel.h \
     mainwindow.h \
     openglwidget.h \
     rubikscube.h \
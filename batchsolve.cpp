@@ -0,0 +1,178 @@
+// Solves scrambles with the two-phase solver on all cores and writes the
+// solutions as CSV. The input holds one scramble per line, or the three
+// line records (time, scramble, solution) that earlier versions of the
+// application wrote into history.txt.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include <algorithm>
+#include <chrono>
+
+#include "notation.h"
+#include "twophasesolver.h"
+#include "workstealingpool.h"
+
+namespace {
+
+struct Job {
+    QString scramble;
+    std::vector<Move> solution;
+    double milliseconds = 0.0;
+    bool valid = false;
+};
+
+// Scrambles are read and solved this many at a time so that the memory
+// use stays flat however long the input is
+constexpr int batchSize = 16384;
+constexpr int jobsPerTask = 64;
+
+// Reads up to batchSize scrambles, skipping the time and solution lines of
+// history records
+void readBatch(QTextStream &in, std::vector<Job> &jobs)
+{
+    static const QRegularExpression timeLine("^\\d+:\\d\\d$");
+    jobs.clear();
+    QString line;
+    while (int(jobs.size()) < batchSize && in.readLineInto(&line)) {
+        line = line.trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        if (timeLine.match(line).hasMatch()) {
+            // history.txt: time, scramble, solution
+            QString scramble = in.readLine().trimmed();
+            in.readLine();
+            jobs.push_back(Job());
+            jobs.back().scramble = scramble;
+        } else {
+            jobs.push_back(Job());
+            jobs.back().scramble = line;
+        }
+    }
+}
+
+void solveJob(Job &job, int maxLength, int timeoutMs)
+{
+    std::vector<Move> scramble;
+    if (!parseMoves(job.scramble.toStdString(), scramble)) {
+        return;
+    }
+    CubeState state;
+    for (Move move : scramble) {
+        state.apply(move);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    job.solution = TwoPhaseSolver::instance().solve(state, maxLength, timeoutMs);
+    job.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    // An empty solution only solves a solved cube
+    job.valid = !job.solution.empty() || state.isSolved();
+}
+
+// A field as RFC 4180 writes it: quoted, with quotes doubled, when it
+// holds a separator, a quote or a line break
+QString csvField(const QString &field)
+{
+    static const QRegularExpression special("[,\"\r\n]");
+    if (!field.contains(special)) {
+        return field;
+    }
+    QString quoted = field;
+    quoted.replace('"', "\"\"");
+    return '"' + quoted + '"';
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Solves scrambles and writes the solutions as CSV");
+    parser.addHelpOption();
+    parser.addPositionalArgument("input", "Scramble file or history.txt, standard input if omitted.");
+    QCommandLineOption outputOption({ "o", "output" }, "CSV file, standard output if omitted.", "file");
+    QCommandLineOption threadsOption("threads", "Worker threads, 0 for one per core.", "threads", "0");
+    QCommandLineOption lengthOption("max-length", "Stop improving a solution at this length.", "moves", "20");
+    QCommandLineOption timeoutOption("timeout", "Time limit per solve.", "ms", "1000");
+    parser.addOptions({ outputOption, threadsOption, lengthOption, timeoutOption });
+    parser.process(app);
+
+    QFile inputFile;
+    if (parser.positionalArguments().isEmpty()) {
+        inputFile.open(stdin, QIODevice::ReadOnly | QIODevice::Text);
+    } else {
+        inputFile.setFileName(parser.positionalArguments().first());
+        if (!inputFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            err << "cannot open " << inputFile.fileName() << "\n";
+            return 1;
+        }
+    }
+    QFile outputFile;
+    if (parser.isSet(outputOption)) {
+        outputFile.setFileName(parser.value(outputOption));
+        if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            err << "cannot open " << outputFile.fileName() << "\n";
+            return 1;
+        }
+    } else {
+        outputFile.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+    QTextStream in(&inputFile);
+    QTextStream out(&outputFile);
+
+    const int maxLength = parser.value(lengthOption).toInt();
+    const int timeoutMs = parser.value(timeoutOption).toInt();
+    WorkStealingPool pool(parser.value(threadsOption).toInt());
+
+    QElapsedTimer timer;
+    timer.start();
+    TwoPhaseSolver::instance();
+    err << "tables ready in " << timer.elapsed() << " ms, solving on " << pool.threadCount() << " threads\n" << Qt::flush;
+
+    out << "index,scramble,solution,moves,time_ms\n";
+    timer.start();
+    std::vector<Job> jobs;
+    qint64 index = 0;
+    qint64 invalid = 0;
+    for (readBatch(in, jobs); !jobs.empty(); readBatch(in, jobs)) {
+        std::vector<WorkStealingPool::Task> tasks;
+        for (size_t first = 0; first < jobs.size(); first += jobsPerTask) {
+            size_t last = std::min(jobs.size(), first + jobsPerTask);
+            tasks.push_back([&jobs, first, last, maxLength, timeoutMs](int) {
+                for (size_t i = first; i < last; ++i) {
+                    solveJob(jobs[i], maxLength, timeoutMs);
+                }
+            });
+        }
+        pool.run(std::move(tasks));
+
+        for (const Job &job : jobs) {
+            out << index++ << ',' << csvField(job.scramble) << ',';
+            if (job.valid) {
+                out << QString::fromStdString(formatMoves(job.solution)) << ',' << job.solution.size() << ','
+                    << QString::number(job.milliseconds, 'f', 3) << '\n';
+            } else {
+                out << ",,\n";
+                ++invalid;
+            }
+        }
+        out.flush();
+    }
+
+    double seconds = timer.elapsed() / 1000.0;
+    err << index << " scrambles in " << QString::number(seconds, 'f', 2) << " s ("
+        << QString::number(seconds > 0.0 ? index / seconds : 0.0, 'f', 1) << " per second)";
+    if (invalid > 0) {
+        err << ", " << invalid << " could not be read or solved";
+    }
+    err << "\n";
+    return 0;
+}
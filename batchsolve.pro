@@ -0,0 +1,14 @@
+# Headless batch solver: scrambles in, CSV out
+# Build it like the application: qmake batchsolve.pro && make
+
+QT       += core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = batchsolve
+
+include(cubecore.pri)
+
+SOURCES += \
+    batchsolve.cpp
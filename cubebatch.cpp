@@ -0,0 +1,301 @@
+#include "cubebatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "statekernel.h"
+
+// GCC's vector types let one loop body serve 16 and 32 cubes at a time
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CUBEBATCH_VECTORS
+#endif
+
+namespace {
+
+// A corner's twist is in 0..2 and a turn adds up to 2
+inline uint8_t twisted(uint8_t cubie, uint8_t twist)
+{
+    uint8_t sum = cubie + twist;
+    return sum >= 0x30 ? sum - 0x30 : sum;
+}
+
+// Byte of the piece that belongs in a slot
+constexpr uint8_t home(int slot)
+{
+    return slot < 8 ? slot : slot - 8;
+}
+
+// For every slot the face turns that put another piece there or change
+// its orientation, the slot the piece comes from and the change
+struct Reach {
+    uint8_t move;
+    uint8_t source;
+    uint8_t orientation;
+};
+
+struct ReachTable {
+    Reach reaches[CubeBatch::slotCount][9] = {};
+    int counts[CubeBatch::slotCount] = {};
+
+    constexpr ReachTable()
+    {
+        for (int move = 0; move < faceTurnCount; ++move) {
+            const MoveTables::CubieMove &cubieMove = MoveTables::faceTurns.moves[move];
+            for (int i = 0; i < 8; ++i) {
+                if (cubieMove.cornerPerm[i] != i || cubieMove.cornerTwist[i] != 0) {
+                    reaches[i][counts[i]++] = { uint8_t(move), cubieMove.cornerPerm[i], uint8_t(cubieMove.cornerTwist[i] << 4) };
+                }
+            }
+            for (int i = 0; i < 12; ++i) {
+                if (cubieMove.edgePerm[i] != i || cubieMove.edgeFlip[i] != 0) {
+                    reaches[8 + i][counts[8 + i]++] = { uint8_t(move), uint8_t(8 + cubieMove.edgePerm[i]), uint8_t(cubieMove.edgeFlip[i] << 4) };
+                }
+            }
+        }
+    }
+};
+
+// Known at compile time, so the unrolled loops below keep the slots in registers
+constexpr ReachTable reachTable;
+
+#ifdef CUBEBATCH_VECTORS
+
+typedef uint8_t Vector16 __attribute__((vector_size(16)));
+typedef uint8_t Vector32 __attribute__((vector_size(32)));
+
+// The helpers must be inlined even in debug builds: called from the AVX2
+// loop as functions of their own, they would pass 32-byte vectors in a
+// different way than it expects
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <typename Vector>
+__attribute__((always_inline)) inline Vector load(const uint8_t *bytes)
+{
+    Vector vector;
+    std::memcpy(&vector, bytes, sizeof(vector));
+    return vector;
+}
+
+template <typename Vector>
+__attribute__((always_inline)) inline void store(uint8_t *bytes, const Vector &vector)
+{
+    std::memcpy(bytes, &vector, sizeof(vector));
+}
+
+template <typename Vector>
+__attribute__((always_inline)) inline Vector twisted(const Vector &cubies, uint8_t twist)
+{
+    Vector sum = cubies + twist;
+    return sum - (Vector(sum >= 0x30) & 0x30);
+}
+
+// Each slot keeps what it holds, or for the cubes whose move reaches it
+// takes the reoriented piece from the source slot
+template <typename Vector>
+__attribute__((always_inline)) inline void turnCubes(const uint8_t *const *in, uint8_t *const *out,
+                                                      const Move *moves, size_t k)
+{
+    const Vector cubeMoves = load<Vector>(reinterpret_cast<const uint8_t *>(moves) + k);
+    Vector making[faceTurnCount];
+    for (int move = 0; move < faceTurnCount; ++move) {
+        making[move] = Vector(cubeMoves == uint8_t(move));
+    }
+    Vector cubies[CubeBatch::slotCount];
+    for (int slot = 0; slot < CubeBatch::slotCount; ++slot) {
+        cubies[slot] = load<Vector>(in[slot] + k);
+    }
+#pragma GCC unroll 20
+    for (int slot = 0; slot < CubeBatch::slotCount; ++slot) {
+        Vector cubie = cubies[slot];
+#pragma GCC unroll 9
+        for (int r = 0; r < reachTable.counts[slot]; ++r) {
+            const Reach &reach = reachTable.reaches[slot][r];
+            Vector piece = slot < 8 ? twisted(cubies[reach.source], reach.orientation)
+                                    : cubies[reach.source] ^ reach.orientation;
+            cubie = (making[reach.move] & piece) | (~making[reach.move] & cubie);
+        }
+        store(out[slot] + k, cubie);
+    }
+}
+
+size_t turnCubes16(const uint8_t *const *in, uint8_t *const *out, const Move *moves, size_t count)
+{
+    size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        turnCubes<Vector16>(in, out, moves, k);
+    }
+    return k;
+}
+
+__attribute__((target("avx2")))
+size_t turnCubes32(const uint8_t *const *in, uint8_t *const *out, const Move *moves, size_t count)
+{
+    size_t k = 0;
+    for (; k + 32 <= count; k += 32) {
+        turnCubes<Vector32>(in, out, moves, k);
+    }
+    return k;
+}
+
+#endif // CUBEBATCH_VECTORS
+
+} // namespace
+
+CubeBatch::CubeBatch(size_t count)
+{
+    resize(count);
+}
+
+void CubeBatch::resize(size_t newCount)
+{
+    // Rows are padded to 64 bytes, so a turn of all cubes can run the
+    // vector loop to the end of the row
+    size_t newStride = (newCount + 63) / 64 * 64;
+    std::vector<uint8_t> newCubies(newStride * slotCount * 2);
+    for (int slot = 0; slot < slotCount; ++slot) {
+        uint8_t *newRow = newCubies.data() + slot * newStride;
+        size_t kept = std::min(count, newCount);
+        if (kept > 0) {
+            std::memcpy(newRow, row(slot), kept);
+        }
+        std::memset(newRow + kept, home(slot), newCount - kept);
+    }
+    cubies.swap(newCubies);
+    count = newCount;
+    stride = newStride;
+    for (int slot = 0; slot < slotCount; ++slot) {
+        rowOf[slot] = slot;
+        spareRowOf[slot] = slotCount + slot;
+    }
+}
+
+void CubeBatch::reset()
+{
+    for (int slot = 0; slot < slotCount; ++slot) {
+        std::memset(row(slot), home(slot), count);
+    }
+}
+
+CubeState CubeBatch::state(size_t cube) const
+{
+    CubeState state;
+    for (int i = 0; i < 8; ++i) {
+        uint8_t cubie = row(i)[cube];
+        state.setCorner(i, cubie & 0x0f, cubie >> 4);
+    }
+    for (int i = 0; i < 12; ++i) {
+        uint8_t cubie = row(8 + i)[cube];
+        state.setEdge(i, cubie & 0x0f, cubie >> 4);
+    }
+    return state;
+}
+
+void CubeBatch::setState(size_t cube, const CubeState &state)
+{
+    for (int i = 0; i < 8; ++i) {
+        row(i)[cube] = uint8_t(state.cornerPiece(i) | state.cornerTwist(i) << 4);
+    }
+    for (int i = 0; i < 12; ++i) {
+        row(8 + i)[cube] = uint8_t(state.edgePiece(i) | state.edgeFlip(i) << 4);
+    }
+}
+
+void CubeBatch::turn(Move move)
+{
+    const MoveTables::CubieMove &cubieMove = MoveTables::faceTurns.moves[move];
+
+    // Every row belongs to one slot, so after moving the rows each one
+    // can be reoriented in place
+    uint8_t moved[slotCount];
+    for (int i = 0; i < 8; ++i) {
+        moved[i] = rowOf[cubieMove.cornerPerm[i]];
+    }
+    for (int i = 0; i < 12; ++i) {
+        moved[8 + i] = rowOf[8 + cubieMove.edgePerm[i]];
+    }
+    std::memcpy(rowOf, moved, sizeof(rowOf));
+
+    for (int i = 0; i < 8; ++i) {
+        if (cubieMove.cornerTwist[i] != 0) {
+            uint8_t *cubie = row(i);
+            const uint8_t twist = cubieMove.cornerTwist[i] << 4;
+            size_t k = 0;
+#ifdef CUBEBATCH_VECTORS
+            for (; k < count; k += 16) {
+                store(cubie + k, twisted(load<Vector16>(cubie + k), twist));
+            }
+#endif
+            for (; k < count; ++k) {
+                cubie[k] = twisted(cubie[k], twist);
+            }
+        }
+    }
+    for (int i = 0; i < 12; ++i) {
+        if (cubieMove.edgeFlip[i] != 0) {
+            uint8_t *cubie = row(8 + i);
+            size_t k = 0;
+#ifdef CUBEBATCH_VECTORS
+            for (; k < count; k += 16) {
+                store(cubie + k, load<Vector16>(cubie + k) ^ 0x10);
+            }
+#endif
+            for (; k < count; ++k) {
+                cubie[k] ^= 0x10;
+            }
+        }
+    }
+}
+
+void CubeBatch::turn(const Move *moves)
+{
+    const uint8_t *in[slotCount];
+    uint8_t *out[slotCount];
+    for (int slot = 0; slot < slotCount; ++slot) {
+        in[slot] = row(slot);
+        out[slot] = cubies.data() + spareRowOf[slot] * stride;
+    }
+
+    size_t k = 0;
+#ifdef CUBEBATCH_VECTORS
+    k = StateKernel::backend() == StateKernel::Avx2 ? turnCubes32(in, out, moves, count)
+                                                    : turnCubes16(in, out, moves, count);
+#endif
+    for (; k < count; ++k) {
+        const MoveTables::CubieMove &cubieMove = MoveTables::faceTurns.moves[moves[k]];
+        for (int i = 0; i < 8; ++i) {
+            out[i][k] = twisted(in[cubieMove.cornerPerm[i]][k], cubieMove.cornerTwist[i] << 4);
+        }
+        for (int i = 0; i < 12; ++i) {
+            out[8 + i][k] = in[8 + cubieMove.edgePerm[i]][k] ^ (cubieMove.edgeFlip[i] << 4);
+        }
+    }
+    std::swap(rowOf, spareRowOf);
+}
+
+size_t CubeBatch::solved(uint8_t *solved) const
+{
+    size_t solvedCount = 0;
+    size_t k = 0;
+#ifdef CUBEBATCH_VECTORS
+    for (; k + 16 <= count; k += 16) {
+        Vector16 difference = {};
+        for (int slot = 0; slot < slotCount; ++slot) {
+            difference |= load<Vector16>(row(slot) + k) ^ home(slot);
+        }
+        Vector16 ones = Vector16(difference == 0) & 1;
+        store(solved + k, ones);
+        for (int i = 0; i < 16; ++i) {
+            solvedCount += ones[i];
+        }
+    }
+#endif
+    for (; k < count; ++k) {
+        uint8_t difference = 0;
+        for (int slot = 0; slot < slotCount; ++slot) {
+            difference |= row(slot)[k] ^ home(slot);
+        }
+        solved[k] = difference == 0;
+        solvedCount += solved[k];
+    }
+    return solvedCount;
+}
@@ -0,0 +1,59 @@
+#ifndef CUBEBATCH_H
+#define CUBEBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "cubestate.h"
+
+// Many independent 3x3x3 cubes in struct-of-arrays layout: one row of
+// bytes per corner or edge slot, one column per cube, each byte encoded
+// like CubeState's. Only face turns in the centers' frame apply.
+//
+// Rows are reached through a slot-to-row table, so the permutation of a
+// turn that is the same for every cube only reorders the table; just the
+// rows whose orientation changes are rewritten. Turns that differ per
+// cube blend, slot by slot, the pieces of every move that can reach it,
+// for 16 cubes at a time, or 32 when StateKernel runs on AVX2.
+class CubeBatch
+{
+public:
+    explicit CubeBatch(size_t count = 0);
+
+    size_t size() const { return count; }
+
+    // New cubes start solved
+    void resize(size_t count);
+    void reset();
+
+    CubeState state(size_t cube) const;
+    void setState(size_t cube, const CubeState &state);
+
+    // The same face turn for every cube
+    void turn(Move move);
+
+    // moves[cube] for every cube, a face turn or MoveTables::noTurn
+    void turn(const Move *moves);
+
+    // Sets solved[cube] to 1 for the solved cubes and 0 for the others,
+    // returns how many are solved
+    size_t solved(uint8_t *solved) const;
+
+    static constexpr int slotCount = 20;    // 8 corners, then 12 edges
+
+private:
+    uint8_t *row(int slot) { return cubies.data() + rowOf[slot] * stride; }
+    const uint8_t *row(int slot) const { return cubies.data() + rowOf[slot] * stride; }
+
+    size_t count = 0;
+    size_t stride = 0;
+
+    // Twice slotCount rows; the ones not in rowOf take the results of
+    // per-cube turns
+    std::vector<uint8_t> cubies;
+    uint8_t rowOf[slotCount];
+    uint8_t spareRowOf[slotCount];
+};
+
+#endif // CUBEBATCH_H
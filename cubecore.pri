@@ -0,0 +1,42 @@
+# GL-free cube model shared by the application and the command line tools
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/cubebatch.cpp \
+    $$PWD/cubestate.cpp \
+    $$PWD/cubesymmetry.cpp \
+    $$PWD/cubiecube.cpp \
+    $$PWD/historylog.cpp \
+    $$PWD/layercube.cpp \
+    $$PWD/notation.cpp \
+    $$PWD/optimalsolver.cpp \
+    $$PWD/patterndatabase.cpp \
+    $$PWD/randomscrambler.cpp \
+    $$PWD/replay.cpp \
+    $$PWD/solvestats.cpp \
+    $$PWD/statekernel.cpp \
+    $$PWD/tablefile.cpp \
+    $$PWD/transpositiontable.cpp \
+    $$PWD/twophasesolver.cpp \
+    $$PWD/workstealingpool.cpp
+
+HEADERS += \
+    $$PWD/cubebatch.h \
+    $$PWD/cubestate.h \
+    $$PWD/cubesymmetry.h \
+    $$PWD/cubiecube.h \
+    $$PWD/historylog.h \
+    $$PWD/layercube.h \
+    $$PWD/movetables.h \
+    $$PWD/notation.h \
+    $$PWD/optimalsolver.h \
+    $$PWD/patterndatabase.h \
+    $$PWD/randomscrambler.h \
+    $$PWD/replay.h \
+    $$PWD/solvestats.h \
+    $$PWD/statekernel.h \
+    $$PWD/tablefile.h \
+    $$PWD/transpositiontable.h \
+    $$PWD/twophasesolver.h \
+    $$PWD/workstealingpool.h
@@ -1,26 +1,29 @@
 #ifndef CUBEGEOMETRY_H
 #define CUBEGEOMETRY_H
 
-#include <QOpenGLFunctions>
-#include <QOpenGLShaderProgram>
-#include <QOpenGLVertexArrayObject>
-#include <QOpenGLBuffer>
-
-class CubeGeometry : protected QOpenGLFunctions
+#include <QMatrix4x4>
+#include <QQuaternion>
+#include <QVector>
+#include <QVector3D>
+
+// One cubie: sticker colors, home position and rotation. The mesh, the
+// shader program and the buffers are shared by all cubies in CubeRenderer.
+class CubeGeometry
 {
 public:
     CubeGeometry();
     CubeGeometry(float size, QVector<QVector3D> color, QVector3D position);
-    virtual ~CubeGeometry();
 
-    void initShader();
-    void prepareModel();
-    void drawCubeGeometry(QMatrix4x4 &projection, QMatrix4x4 &view);
+    float GetSize() const { return size; }
+
+    // Colors of the back, top, bottom, right, left and front faces
+    const QVector<QVector3D> &GetColors() const { return color; }
+
     void SetPosition(QVector3D position);
     QVector3D GetPosition();
 
     void SetModel(QMatrix4x4 model);
-    QMatrix4x4 GetModel();
+    QMatrix4x4 GetModel() const;
 
     void rotateCube(QQuaternion &rotation);
 
@@ -30,16 +33,8 @@ public:
     void SetTargetRotation(QQuaternion targetRotation);
     QQuaternion GetTargetRotation();
 
-
 private:
-    void initCubeGeometry();
-
-    QOpenGLShaderProgram *program;
-    QOpenGLBuffer *vertBuff;
-    QOpenGLBuffer *indBuff;
-    QOpenGLVertexArrayObject *vao;
-
-    float size;
+    float size = 0.25f;
     QVector<QVector3D> color;
 
     QVector3D position;
@@ -47,9 +42,6 @@ private:
 
     QQuaternion rotation;
     QQuaternion targetRotation;
-
-    QVector<QVector3D> vertices;
-    QVector<GLushort> indices;
 };
 
 #endif // CUBEGEOMETRY_H
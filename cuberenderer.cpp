@@ -0,0 +1,135 @@
+#include "cuberenderer.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+CubeRenderer::CubeRenderer()
+    : meshBuffer(QOpenGLBuffer::VertexBuffer)
+    , indexBuffer(QOpenGLBuffer::IndexBuffer)
+    , instanceBuffer(QOpenGLBuffer::VertexBuffer)
+{}
+
+CubeRenderer::~CubeRenderer()
+{
+    delete program;
+}
+
+void CubeRenderer::initialize(float size)
+{
+    initializeOpenGLFunctions();
+
+    program = new QOpenGLShaderProgram();
+    program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/vertexShader.vert");
+    program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/fragmentShader.frag");
+    program->link();
+    if (!program->isLinked()) {
+        qDebug() << program->log();
+    }
+
+    // Position and the face the vertex belongs to, in the order of
+    // CubeGeometry::GetColors()
+    const float vertices[] = {
+        // back side
+        -size, -size, -size, 0,   size, -size, -size, 0,   size,  size, -size, 0,  -size,  size, -size, 0,
+        // top side
+         size,  size, -size, 1,  -size,  size, -size, 1,  -size,  size,  size, 1,   size,  size,  size, 1,
+        // bottom side
+        -size, -size, -size, 2,   size, -size, -size, 2,   size, -size,  size, 2,  -size, -size,  size, 2,
+        // right side
+         size, -size, -size, 3,   size,  size, -size, 3,   size,  size,  size, 3,   size, -size,  size, 3,
+        // left side
+        -size, -size, -size, 4,  -size,  size, -size, 4,  -size,  size,  size, 4,  -size, -size,  size, 4,
+        // front side
+        -size, -size,  size, 5,   size, -size,  size, 5,   size,  size,  size, 5,  -size,  size,  size, 5
+    };
+    const GLushort indices[] = {
+        0, 1, 2, 2, 3, 0,
+        4, 5, 6, 6, 7, 4,
+        8, 9, 10, 10, 11, 8,
+        12, 13, 14, 14, 15, 12,
+        16, 17, 18, 18, 19, 16,
+        20, 21, 22, 22, 23, 20
+    };
+    indexCount = sizeof(indices) / sizeof(indices[0]);
+
+    vao.create();
+    vao.bind();
+
+    meshBuffer.create();
+    meshBuffer.bind();
+    meshBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    meshBuffer.allocate(vertices, sizeof(vertices));
+
+    int positionLocation = program->attributeLocation("a_pos");
+    program->enableAttributeArray(positionLocation);
+    program->setAttributeBuffer(positionLocation, GL_FLOAT, 0, 3, 4 * sizeof(float));
+    int faceLocation = program->attributeLocation("a_face");
+    program->enableAttributeArray(faceLocation);
+    program->setAttributeBuffer(faceLocation, GL_FLOAT, 3 * sizeof(float), 1, 4 * sizeof(float));
+
+    instanceBuffer.create();
+    instanceBuffer.bind();
+    instanceBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+
+    const int stride = instanceFloats * sizeof(float);
+    // A mat4 attribute takes four consecutive locations, one per column
+    int modelLocation = program->attributeLocation("a_model");
+    for (int column = 0; column < 4; ++column) {
+        program->enableAttributeArray(modelLocation + column);
+        program->setAttributeBuffer(modelLocation + column, GL_FLOAT, column * 4 * sizeof(float), 4, stride);
+        glVertexAttribDivisor(modelLocation + column, 1);
+    }
+    for (int face = 0; face < 6; ++face) {
+        int colorLocation = program->attributeLocation(QString("a_color%1").arg(face).toLatin1().constData());
+        program->enableAttributeArray(colorLocation);
+        program->setAttributeBuffer(colorLocation, GL_FLOAT, (16 + face * 3) * sizeof(float), 3, stride);
+        glVertexAttribDivisor(colorLocation, 1);
+    }
+
+    indexBuffer.create();
+    indexBuffer.bind();
+    indexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    indexBuffer.allocate(indices, sizeof(indices));
+
+    vao.release();
+}
+
+void CubeRenderer::destroy()
+{
+    vao.destroy();
+    meshBuffer.destroy();
+    indexBuffer.destroy();
+    instanceBuffer.destroy();
+    delete program;
+    program = nullptr;
+}
+
+void CubeRenderer::draw(const QMatrix4x4 &projection, const QMatrix4x4 &view, const QVector<CubeGeometry> &cubes)
+{
+    instanceData.resize(cubes.size() * instanceFloats);
+    float *data = instanceData.data();
+    for (const CubeGeometry &cube : cubes) {
+        QMatrix4x4 model = cube.GetModel();
+        // Column-major, the layout the shader's mat4 attribute expects
+        std::copy(model.constData(), model.constData() + 16, data);
+        data += 16;
+        for (const QVector3D &color : cube.GetColors()) {
+            *data++ = color.x();
+            *data++ = color.y();
+            *data++ = color.z();
+        }
+    }
+
+    instanceBuffer.bind();
+    instanceBuffer.allocate(instanceData.constData(), instanceData.size() * sizeof(float));
+    instanceBuffer.release();
+
+    program->bind();
+    program->setUniformValue("vp_matrix", projection * view);
+    vao.bind();
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, nullptr, cubes.size());
+    ++drawCalls;
+    vao.release();
+    program->release();
+}
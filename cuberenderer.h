@@ -0,0 +1,46 @@
+#ifndef CUBERENDERER_H
+#define CUBERENDERER_H
+
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QVector>
+
+#include "cubegeometry.h"
+
+// Draws all cubies with one instanced call: a single cube mesh and shader
+// program, with every cubie's model matrix and sticker colors passed as
+// per-instance attributes.
+class CubeRenderer : protected QOpenGLExtraFunctions
+{
+public:
+    CubeRenderer();
+    ~CubeRenderer();
+
+    // Needs a current context; size is half the edge of a cubie
+    void initialize(float size);
+    void destroy();
+
+    // Uses every cubie's GetModel()
+    void draw(const QMatrix4x4 &projection, const QMatrix4x4 &view, const QVector<CubeGeometry> &cubes);
+
+    // Draw calls issued so far
+    int getDrawCalls() const { return drawCalls; }
+
+private:
+    // Per instance: model matrix and six colors
+    static constexpr int instanceFloats = 16 + 6 * 3;
+
+    QOpenGLShaderProgram *program = nullptr;
+    QOpenGLVertexArrayObject vao;
+    QOpenGLBuffer meshBuffer;
+    QOpenGLBuffer indexBuffer;
+    QOpenGLBuffer instanceBuffer;
+    int indexCount = 0;
+    int drawCalls = 0;
+
+    QVector<float> instanceData;
+};
+
+#endif // CUBERENDERER_H
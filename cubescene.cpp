@@ -0,0 +1,115 @@
+#include "cubescene.h"
+#include <QtMath>
+
+CubeScene::CubeScene(RubiksCube *rubiksCube)
+    : rubiksCube(rubiksCube)
+{
+    setupCamera();
+    orientationClock.start();
+}
+
+void CubeScene::initialize()
+{
+    initializeOpenGLFunctions();
+    renderer.initialize(1.0f);
+    profiler.initializeGpu();
+    glClearColor(0.7f, 1.0f, 0.7f, 1.0f);
+    // glClearColor(0.9529f, 0.9529f, 0.9529f, 1.0f);
+}
+
+void CubeScene::destroy()
+{
+    renderer.destroy();
+    profiler.destroyGpu();
+}
+
+void CubeScene::resize(int w, int h)
+{
+    // Calculate aspect ratio
+    qreal aspect = qreal(w) / qreal(h ? h : 1);
+
+    // Set near plane to 0.1, far plane to 50.0, field of view 45 degrees
+    const qreal zNear = 0.1, zFar = 50.0, fov = 45.0;
+
+    // Reset projection
+    projection.setToIdentity();
+
+    // Set perspective projection
+    projection.perspective(fov, aspect, zNear, zFar);
+}
+
+bool CubeScene::render()
+{
+    profiler.beginFrame();
+
+    // Clear color and depth buffer
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glEnable(GL_DEPTH_TEST);
+
+    bool animating = false;
+
+    // The whole cube turns as fast as a side
+    double progress = orientationClock.nsecsElapsed() / 1e6 / rubiksCube->getTurnDuration();
+    if (progress < 1.0) {
+        currentOrientation = QQuaternion::slerp(startOrientation, targetOrientation, float(progress));
+        animating = true;
+    } else {
+        currentOrientation = targetOrientation;
+    }
+
+    // Calculate view transformation
+
+    view.setToIdentity();
+    QVector3D front(0.0f, 0.0f, 0.0f);
+    front.setX(cos(qDegreesToRadians(yaw)) * cos(qDegreesToRadians(pitch)));
+    front.setY(sin(qDegreesToRadians(pitch)));
+    front.setZ(sin(qDegreesToRadians(yaw)) * cos(qDegreesToRadians(pitch)));
+    cameraFront = front.normalized();
+
+    view.lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+    profiler.endSection(FrameProfiler::ViewSetup);
+
+    // Update the cubies' models, then draw them all at once
+    animating |= rubiksCube->animate();
+    for (CubeGeometry &cube : rubiksCube->getCubes()) {
+        model.setToIdentity();
+        model.rotate(currentOrientation);
+        model.rotate(cube.GetRotation());
+
+        model.translate(cube.GetPosition());
+        // The mesh is a unit cubie, scaled to the cube's size
+        model.scale(cube.GetSize());
+        cube.SetModel(model);
+    }
+    profiler.endSection(FrameProfiler::Cubies);
+
+    renderer.draw(projection, view, rubiksCube->getCubes());
+    profiler.endSection(FrameProfiler::Submission);
+    profiler.endFrame();
+
+    return animating;
+}
+
+void CubeScene::rotateOrientation(const QQuaternion &rotation)
+{
+    startOrientation = currentOrientation;
+    targetOrientation = rotation.normalized() * targetOrientation;
+    orientationClock.start();
+}
+
+void CubeScene::resetOrientation()
+{
+    startOrientation = QQuaternion();
+    targetOrientation = QQuaternion();
+    currentOrientation = QQuaternion();
+}
+
+void CubeScene::setupCamera()
+{
+    // Camera setup
+    cameraPos = QVector3D(3.0f, 3.0f, 3.0f);
+    cameraFront = QVector3D(-0.525f, -0.525f, 0.525f) - cameraPos;
+    cameraFront.normalize();
+    cameraUp = QVector3D(0.0f, 1.0f, 0.0f);
+}
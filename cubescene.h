@@ -0,0 +1,68 @@
+#ifndef CUBESCENE_H
+#define CUBESCENE_H
+
+#include <QElapsedTimer>
+#include <QMatrix4x4>
+#include <QOpenGLFunctions>
+#include <QQuaternion>
+#include <QVector3D>
+
+#include "cuberenderer.h"
+#include "frameprofiler.h"
+#include "rubikscube.h"
+
+// What a frame of OpenGLWidget draws: the camera, the whole cube's
+// orientation, the cubies' turn animations and the instanced draw, timed by
+// a FrameProfiler. Kept apart from the widget so the offscreen benchmark
+// renders exactly the same way.
+class CubeScene : protected QOpenGLFunctions
+{
+public:
+    explicit CubeScene(RubiksCube *rubiksCube);
+
+    // Both need a current context
+    void initialize();
+    void destroy();
+
+    void resize(int w, int h);
+
+    // Draws one frame into the bound framebuffer; true while an animation
+    // still needs more frames
+    bool render();
+
+    // Turns the whole cube, animated over one turn duration
+    void rotateOrientation(const QQuaternion &rotation);
+    // Back to the starting view, without animation
+    void resetOrientation();
+
+    const FrameProfiler &getProfiler() const { return profiler; }
+    int getDrawCalls() const { return renderer.getDrawCalls(); }
+
+private:
+    void setupCamera();
+
+    RubiksCube *rubiksCube;
+    CubeRenderer renderer;
+    FrameProfiler profiler;
+
+    QVector3D cameraPos;
+    QVector3D cameraFront;
+    QVector3D cameraUp;
+
+    QMatrix4x4 projection;
+    QMatrix4x4 model;
+    QMatrix4x4 view;
+
+    // float yaw = 270.0f;
+    float yaw = 225.0f;
+    float pitch = -35.0f;
+    // float pitch = 0.0f;
+
+    QQuaternion startOrientation;
+    QQuaternion targetOrientation;
+    QQuaternion currentOrientation;
+    // Time since the whole cube started its last turn
+    QElapsedTimer orientationClock;
+};
+
+#endif // CUBESCENE_H
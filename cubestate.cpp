@@ -0,0 +1,197 @@
+#include "cubestate.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "statekernel.h"
+
+namespace {
+
+int screenFace(char side)
+{
+    switch (side) {
+    case 'U': return FaceU;
+    case 'R': return FaceR;
+    case 'F': return FaceF;
+    case 'D': return FaceD;
+    case 'L': return FaceL;
+    case 'B': return FaceB;
+    default: return -1;
+    }
+}
+
+constexpr uint64_t splitMix(uint64_t &x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// A random key for every byte a slot can hold; corners first, then edges
+struct ZobristKeys {
+    uint64_t keys[20][48] = {};
+
+    constexpr ZobristKeys()
+    {
+        uint64_t seed = 0x43554245;
+        for (auto &slot : keys) {
+            for (uint64_t &key : slot) {
+                key = splitMix(seed);
+            }
+        }
+    }
+};
+
+constexpr ZobristKeys zobrist;
+
+} // namespace
+
+const uint8_t CubeState::cornersOnFace[6][4] = {
+    { URF, UFL, ULB, UBR }, // U
+    { URF, UBR, DRB, DFR }, // R
+    { URF, UFL, DLF, DFR }, // F
+    { DFR, DLF, DBL, DRB }, // D
+    { UFL, ULB, DBL, DLF }, // L
+    { ULB, UBR, DRB, DBL }  // B
+};
+
+const uint8_t CubeState::edgesOnFace[6][4] = {
+    { UR, UF, UL, UB }, // U
+    { UR, BR, DR, FR }, // R
+    { UF, FR, DF, FL }, // F
+    { DR, DF, DL, DB }, // D
+    { UL, FL, DL, BL }, // L
+    { UB, BL, DB, BR }  // B
+};
+
+CubeState::CubeState()
+{
+    for (int i = 0; i < 8; ++i) {
+        corners[i] = i;
+    }
+    for (int i = 0; i < 12; ++i) {
+        edges[i] = i;
+    }
+    for (int i = 0; i < 6; ++i) {
+        centers[i] = i;
+    }
+}
+
+void CubeState::apply(Move move)
+{
+    const MoveTables::MoveSteps &steps = MoveTables::moveSteps.moves[move];
+
+    // Remap the turns through the current centers; face 6 keeps noTurn in place
+    uint8_t faces[7] = { centers[0], centers[1], centers[2], centers[3], centers[4], centers[5], 6 };
+    Move turns[2] = {
+        Move(faces[steps.turns[0] / 3] * 3 + steps.turns[0] % 3),
+        Move(faces[steps.turns[1] / 3] * 3 + steps.turns[1] % 3)
+    };
+    turn(turns, 2);
+
+    for (int i = 0; i < 6; ++i) {
+        centers[i] = faces[steps.centerPerm[i]];
+    }
+}
+
+void CubeState::turn(Move move)
+{
+    turn(&move, 1);
+}
+
+void CubeState::turn(const Move *moves, size_t count)
+{
+    static_assert(offsetof(CubeState, edges) == offsetof(CubeState, corners) + 8
+                  && offsetof(CubeState, centers) == offsetof(CubeState, edges) + 12,
+                  "the kernel reads corners, edges and four centers as one block");
+    StateKernel::turn(corners, moves, count);
+}
+
+void CubeState::turnFace(char side, bool clockwise)
+{
+    int face = screenFace(side);
+    if (face < 0) {
+        return;
+    }
+    apply(Move(face * 3 + (clockwise ? 0 : 2)));
+}
+
+void CubeState::rotate(char axis, bool clockwise)
+{
+    int rotation;
+    switch (axis) {
+    case 'x': rotation = MoveX; break;
+    case 'y': rotation = MoveY; break;
+    case 'z': rotation = MoveZ; break;
+    default: return;
+    }
+    apply(Move(rotation + (clockwise ? 0 : 2)));
+}
+
+Face CubeState::faceAt(char side) const
+{
+    int face = screenFace(side);
+    return Face(face < 0 ? face : centers[face]);
+}
+
+char CubeState::sideOf(Face face) const
+{
+    static const char sides[] = "URFDLB";
+    for (int i = 0; i < 6; ++i) {
+        if (centers[i] == face) {
+            return sides[i];
+        }
+    }
+    return 0;
+}
+
+bool CubeState::isSolved() const
+{
+    for (int i = 0; i < 8; ++i) {
+        if (corners[i] != i) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 12; ++i) {
+        if (edges[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t CubeState::hash() const
+{
+    uint64_t hash = 0;
+    for (int i = 0; i < 8; ++i) {
+        hash ^= zobrist.keys[i][corners[i]];
+    }
+    for (int i = 0; i < 12; ++i) {
+        hash ^= zobrist.keys[8 + i][edges[i]];
+    }
+    return hash;
+}
+
+uint64_t CubeState::hashAfterTurn(uint64_t hash, Move move) const
+{
+    const int face = move / 3;
+    const MoveTables::CubieMove &cubieMove = MoveTables::faceTurns.moves[move];
+    for (int slot : cornersOnFace[face]) {
+        uint8_t piece = corners[cubieMove.cornerPerm[slot]];
+        uint8_t twist = ((piece >> 4) + cubieMove.cornerTwist[slot]) % 3;
+        hash ^= zobrist.keys[slot][corners[slot]] ^ zobrist.keys[slot][(piece & 0x0f) | twist << 4];
+    }
+    for (int slot : edgesOnFace[face]) {
+        uint8_t piece = edges[cubieMove.edgePerm[slot]] ^ (cubieMove.edgeFlip[slot] << 4);
+        hash ^= zobrist.keys[8 + slot][edges[slot]] ^ zobrist.keys[8 + slot][piece];
+    }
+    return hash;
+}
+
+bool CubeState::operator==(const CubeState &other) const
+{
+    return std::memcmp(corners, other.corners, sizeof(corners)) == 0
+        && std::memcmp(edges, other.edges, sizeof(edges)) == 0
+        && std::memcmp(centers, other.centers, sizeof(centers)) == 0;
+}
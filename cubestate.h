@@ -0,0 +1,74 @@
+#ifndef CUBESTATE_H
+#define CUBESTATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "movetables.h"
+
+// GL-free cubie-level state of a 3x3x3 cube.
+//
+// Corners and edges are stored in the frame of the cube's own centers
+// (the model space the renderer draws in), one byte per slot: the low
+// nibble is the piece that currently sits in the slot and the high nibble
+// its orientation. centers[screenFace] holds the face whose center is
+// currently seen on that side, so whole-cube rotations only touch six bytes.
+class CubeState
+{
+public:
+    CubeState();
+
+    // Any move as seen in the current orientation
+    void apply(Move move);
+
+    // Face turn in the centers' frame; move must be one of the 18 face turns
+    void turn(Move move);
+
+    // A sequence of them, kept in vector registers from first to last
+    void turn(const Move *moves, size_t count);
+
+    // Face turn as seen in the current orientation ('U', 'D', 'L', 'R', 'F', 'B')
+    void turnFace(char side, bool clockwise);
+
+    // Whole-cube rotation around the screen x, y or z axis
+    void rotate(char axis, bool clockwise);
+
+    // Face of the centers' frame that is currently seen on a screen side
+    Face faceAt(char side) const;
+
+    // Screen side on which a face of the centers' frame is currently seen
+    char sideOf(Face face) const;
+
+    bool isSolved() const;
+
+    int cornerPiece(int slot) const { return corners[slot] & 0x0f; }
+    int cornerTwist(int slot) const { return corners[slot] >> 4; }
+    int edgePiece(int slot) const { return edges[slot] & 0x0f; }
+    int edgeFlip(int slot) const { return edges[slot] >> 4; }
+
+    // Puts a piece into a slot as is; the caller keeps the state solvable
+    void setCorner(int slot, int piece, int twist) { corners[slot] = uint8_t(piece | twist << 4); }
+    void setEdge(int slot, int piece, int flip) { edges[slot] = uint8_t(piece | flip << 4); }
+
+    // Zobrist hash of the corners and edges; the centers are left out, so
+    // the hash stays put under whole-cube rotations
+    uint64_t hash() const;
+
+    // hash() after turn(move) without turning, from hash() now: only the
+    // eight slots the turn moves are looked at
+    uint64_t hashAfterTurn(uint64_t hash, Move move) const;
+
+    bool operator==(const CubeState &other) const;
+    bool operator!=(const CubeState &other) const { return !(*this == other); }
+
+    // Slots that lie on a face of the centers' frame
+    static const uint8_t cornersOnFace[6][4];
+    static const uint8_t edgesOnFace[6][4];
+
+private:
+    uint8_t corners[8];
+    uint8_t edges[12];
+    uint8_t centers[6];
+};
+
+#endif // CUBESTATE_H
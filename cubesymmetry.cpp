@@ -0,0 +1,172 @@
+#include "cubesymmetry.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr int slotCount = 20;   // 8 corners, then 12 edges
+
+// Slot i of a conjugate is filled from slot source[i], whose byte is
+// rewritten by cubies[i]. Bytes are encoded as in CubeState.
+struct Conjugation {
+    uint8_t source[slotCount];
+    uint8_t cubies[slotCount][48];
+};
+
+struct Conjugations {
+    Conjugations();
+
+    Conjugation conjugations[symmetryCount];
+    Move moves[symmetryCount][faceTurnCount];
+};
+
+Conjugations::Conjugations()
+{
+    for (int sym = 0; sym < symmetryCount; ++sym) {
+        Conjugation &conjugation = conjugations[sym];
+        const CubieCube &inverse = symmetryCube(symmetryInverse(sym));
+
+        // S * cube * S^-1 reads slot i only from slot S^-1.cp[i] of the
+        // cube, so it is enough to put one piece there, the rest need not
+        // make a valid cube
+        for (int i = 0; i < 8; ++i) {
+            const int source = inverse.cp[i];
+            conjugation.source[i] = source;
+            for (int piece = 0; piece < 8; ++piece) {
+                for (int twist = 0; twist < 3; ++twist) {
+                    CubieCube cube;
+                    cube.cp[source] = piece;
+                    cube.co[source] = twist;
+                    CubieCube result = conjugate(cube, sym);
+                    conjugation.cubies[i][piece | twist << 4] = result.cp[i] | result.co[i] << 4;
+                }
+            }
+        }
+        for (int i = 0; i < 12; ++i) {
+            const int source = inverse.ep[i];
+            conjugation.source[8 + i] = 8 + source;
+            for (int piece = 0; piece < 12; ++piece) {
+                for (int flip = 0; flip < 2; ++flip) {
+                    CubieCube cube;
+                    cube.ep[source] = piece;
+                    cube.eo[source] = flip;
+                    CubieCube result = conjugate(cube, sym);
+                    conjugation.cubies[8 + i][piece | flip << 4] = result.ep[i] | result.eo[i] << 4;
+                }
+            }
+        }
+
+        CubieCube turned[faceTurnCount];
+        for (int move = 0; move < faceTurnCount; ++move) {
+            turned[move].turn(move);
+        }
+        for (int move = 0; move < faceTurnCount; ++move) {
+            CubieCube result = conjugate(turned[move], sym);
+            for (int other = 0; other < faceTurnCount; ++other) {
+                if (result == turned[other]) {
+                    moves[sym][move] = Move(other);
+                }
+            }
+        }
+    }
+}
+
+const Conjugations &conjugations()
+{
+    static const Conjugations table;
+    return table;
+}
+
+void readCubies(const CubeState &state, uint8_t *cubies)
+{
+    for (int i = 0; i < 8; ++i) {
+        cubies[i] = uint8_t(state.cornerPiece(i) | state.cornerTwist(i) << 4);
+    }
+    for (int i = 0; i < 12; ++i) {
+        cubies[8 + i] = uint8_t(state.edgePiece(i) | state.edgeFlip(i) << 4);
+    }
+}
+
+CubeState fromCubies(const uint8_t *cubies)
+{
+    CubeState state;
+    for (int i = 0; i < 8; ++i) {
+        state.setCorner(i, cubies[i] & 0x0f, cubies[i] >> 4);
+    }
+    for (int i = 0; i < 12; ++i) {
+        state.setEdge(i, cubies[8 + i] & 0x0f, cubies[8 + i] >> 4);
+    }
+    return state;
+}
+
+} // namespace
+
+CubeState conjugate(const CubeState &state, int sym)
+{
+    const Conjugation &conjugation = conjugations().conjugations[sym];
+    uint8_t cubies[slotCount];
+    uint8_t result[slotCount];
+    readCubies(state, cubies);
+    for (int i = 0; i < slotCount; ++i) {
+        result[i] = conjugation.cubies[i][cubies[conjugation.source[i]]];
+    }
+    return fromCubies(result);
+}
+
+Move conjugateMove(Move move, int sym)
+{
+    return move < faceTurnCount ? conjugations().moves[sym][move] : move;
+}
+
+CubeState canonical(const CubeState &state, int symmetries, int *sym)
+{
+    const Conjugations &table = conjugations();
+    uint8_t cubies[slotCount];
+    uint8_t best[slotCount];
+    readCubies(state, cubies);
+    std::memcpy(best, cubies, sizeof(best));
+    int bestSym = 0;
+
+    // Conjugates mostly differ in their first slot already, so that is
+    // taken for every symmetry without branches, and only the ones that
+    // tie with the least are built further
+    uint8_t first[symmetryCount];
+    uint8_t least = best[0];
+    for (int s = 1; s < symmetries; ++s) {
+        const Conjugation &conjugation = table.conjugations[s];
+        first[s] = conjugation.cubies[0][cubies[conjugation.source[0]]];
+        least = first[s] < least ? first[s] : least;
+    }
+    for (int s = 1; s < symmetries; ++s) {
+        if (first[s] != least) {
+            continue;
+        }
+        const Conjugation &conjugation = table.conjugations[s];
+        int i = best[0] == least ? 1 : 0;
+        uint8_t cubie = least;
+        for (; i < slotCount; ++i) {
+            cubie = conjugation.cubies[i][cubies[conjugation.source[i]]];
+            if (cubie != best[i]) {
+                break;
+            }
+        }
+        if (i == slotCount || cubie > best[i]) {
+            continue;
+        }
+        best[i] = cubie;
+        for (++i; i < slotCount; ++i) {
+            best[i] = conjugation.cubies[i][cubies[conjugation.source[i]]];
+        }
+        bestSym = s;
+    }
+
+    if (sym) {
+        *sym = bestSym;
+    }
+    return fromCubies(best);
+}
+
+uint64_t canonicalHash(const CubeState &state, int symmetries)
+{
+    return canonical(state, symmetries).hash();
+}
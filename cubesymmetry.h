@@ -0,0 +1,31 @@
+#ifndef CUBESYMMETRY_H
+#define CUBESYMMETRY_H
+
+#include <cstdint>
+
+#include "cubiecube.h"
+
+// Symmetry reduction of CubeState: states that are the same up to a
+// rotation or reflection of the whole cube share one representative, the
+// conjugate whose corner and edge bytes compare least. Symmetries are
+// numbered as in symmetryCube(), so passing symmetryCountUD keeps to the
+// ones the two-phase coordinates use.
+//
+// Only corners and edges take part; the results have solved centers.
+
+// symmetryCube(sym) * state * symmetryCube(sym)^-1
+CubeState conjugate(const CubeState &state, int sym);
+
+// The face turn that conjugate() turns move into; a mirror reverses the
+// direction. A solution of conjugate(state, sym) becomes one of state with
+// every move conjugated by symmetryInverse(sym).
+Move conjugateMove(Move move, int sym);
+
+// The least conjugate of state under the first symmetries; sym, when
+// given, gets one symmetry that maps state to it
+CubeState canonical(const CubeState &state, int symmetries = symmetryCount, int *sym = nullptr);
+
+// canonical(state, symmetries).hash(), for tables that hold one entry per class
+uint64_t canonicalHash(const CubeState &state, int symmetries = symmetryCount);
+
+#endif // CUBESYMMETRY_H
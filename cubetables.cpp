@@ -0,0 +1,64 @@
+// Writes the two-phase and the optimal solver tables into a directory.
+// Valid files that are already there are kept unless --force is given.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include "patterndatabase.h"
+#include "tablefile.h"
+#include "twophasesolver.h"
+
+namespace {
+
+bool checkFile(QTextStream &out, const QString &fileName, qint64 elapsed)
+{
+    QString path = TableFile::path(fileName);
+    QFile file(path);
+    if (!file.exists()) {
+        out << "could not write " << path << "\n";
+        return false;
+    }
+    out << path << ": " << file.size() / (1024 * 1024) << " MB, ready in " << elapsed << " ms\n" << Qt::flush;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates the solver table files");
+    parser.addHelpOption();
+    QCommandLineOption outputOption("output", "Directory of the RubiksCube binary.", "directory",
+                                    QCoreApplication::applicationDirPath());
+    QCommandLineOption forceOption("force", "Rebuild the tables even if valid files exist.");
+    parser.addOptions({ outputOption, forceOption });
+    parser.process(app);
+
+    QString directory = parser.value(outputOption);
+    if (!QDir().mkpath(directory)) {
+        out << "cannot create " << directory << "\n";
+        return 1;
+    }
+    TableFile::setDirectory(directory);
+    if (parser.isSet(forceOption)) {
+        QFile::remove(TableFile::path(TwoPhaseSolver::tableFileName));
+        QFile::remove(TableFile::path(PatternDatabases::tableFileName));
+    }
+
+    // Loading the tables builds and writes them when there is no valid file
+    QElapsedTimer timer;
+    timer.start();
+    TwoPhaseSolver::instance();
+    bool ok = checkFile(out, TwoPhaseSolver::tableFileName, timer.restart());
+    PatternDatabases::instance();
+    ok = checkFile(out, PatternDatabases::tableFileName, timer.elapsed()) && ok;
+    return ok ? 0 : 1;
+}
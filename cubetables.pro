@@ -0,0 +1,16 @@
+# Pre-generates the solver table files so that RubiksCube maps them on
+# start instead of building them on the first solve
+# Build it like the application: qmake cubetables.pro && make
+# Run it with --output set to the directory of the RubiksCube binary
+
+QT       += core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = cubetables
+
+include(cubecore.pri)
+
+SOURCES += \
+    cubetables.cpp
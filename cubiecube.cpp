@@ -0,0 +1,365 @@
+#include "cubiecube.h"
+
+#include <cstring>
+
+CubieCube::CubieCube()
+{
+    for (int i = 0; i < 8; ++i) {
+        cp[i] = i;
+        co[i] = 0;
+    }
+    for (int i = 0; i < 12; ++i) {
+        ep[i] = i;
+        eo[i] = 0;
+    }
+}
+
+CubieCube::CubieCube(const CubeState &state)
+{
+    for (int i = 0; i < 8; ++i) {
+        cp[i] = state.cornerPiece(i);
+        co[i] = state.cornerTwist(i);
+    }
+    for (int i = 0; i < 12; ++i) {
+        ep[i] = state.edgePiece(i);
+        eo[i] = state.edgeFlip(i);
+    }
+}
+
+void CubieCube::turn(int move)
+{
+    const MoveTables::CubieMove &m = MoveTables::faceTurns.moves[move];
+    CubieCube old = *this;
+    for (int i = 0; i < 8; ++i) {
+        cp[i] = old.cp[m.cornerPerm[i]];
+        co[i] = (old.co[m.cornerPerm[i]] + m.cornerTwist[i]) % 3;
+    }
+    for (int i = 0; i < 12; ++i) {
+        ep[i] = old.ep[m.edgePerm[i]];
+        eo[i] = old.eo[m.edgePerm[i]] ^ m.edgeFlip[i];
+    }
+}
+
+void CubieCube::multiply(const CubieCube &other)
+{
+    CubieCube old = *this;
+    for (int i = 0; i < 8; ++i) {
+        cp[i] = old.cp[other.cp[i]];
+        int a = old.co[other.cp[i]];
+        int b = other.co[i];
+        int twist;
+        if (a < 3 && b < 3) {
+            twist = (a + b) % 3;
+        } else if (a < 3) {
+            twist = a + b;
+            if (twist >= 6) twist -= 3;
+        } else if (b < 3) {
+            twist = a - b;
+            if (twist < 3) twist += 3;
+        } else {
+            twist = a - b;
+            if (twist < 0) twist += 3;
+        }
+        co[i] = twist;
+    }
+    for (int i = 0; i < 12; ++i) {
+        ep[i] = old.ep[other.ep[i]];
+        eo[i] = old.eo[other.ep[i]] ^ other.eo[i];
+    }
+}
+
+CubieCube CubieCube::inverse() const
+{
+    CubieCube inverse;
+    for (int i = 0; i < 8; ++i) {
+        inverse.cp[cp[i]] = i;
+    }
+    for (int i = 0; i < 8; ++i) {
+        int twist = co[inverse.cp[i]];
+        inverse.co[i] = twist >= 3 ? twist : (3 - twist) % 3;
+    }
+    for (int i = 0; i < 12; ++i) {
+        inverse.ep[ep[i]] = i;
+    }
+    for (int i = 0; i < 12; ++i) {
+        inverse.eo[i] = eo[inverse.ep[i]];
+    }
+    return inverse;
+}
+
+bool CubieCube::operator==(const CubieCube &other) const
+{
+    return std::memcmp(this, &other, sizeof(CubieCube)) == 0;
+}
+
+int CubieCube::twist() const
+{
+    int twist = 0;
+    for (int i = 0; i < 7; ++i) {
+        twist = twist * 3 + co[i];
+    }
+    return twist;
+}
+
+void CubieCube::setTwist(int twist)
+{
+    int sum = 0;
+    for (int i = 6; i >= 0; --i) {
+        co[i] = twist % 3;
+        sum += co[i];
+        twist /= 3;
+    }
+    co[7] = (3 - sum % 3) % 3;
+}
+
+int CubieCube::flip() const
+{
+    int flip = 0;
+    for (int i = 0; i < 11; ++i) {
+        flip = flip * 2 + eo[i];
+    }
+    return flip;
+}
+
+void CubieCube::setFlip(int flip)
+{
+    int sum = 0;
+    for (int i = 10; i >= 0; --i) {
+        eo[i] = flip & 1;
+        sum += eo[i];
+        flip >>= 1;
+    }
+    eo[11] = sum & 1;
+}
+
+int CubieCube::slice() const
+{
+    int slice = 0;
+    int found = 0;
+    for (int j = 11; j >= 0; --j) {
+        if (ep[j] >= FR) {
+            slice += binomial(11 - j, found + 1);
+            ++found;
+        }
+    }
+    return slice;
+}
+
+void CubieCube::setSlice(int slice)
+{
+    int sliceEdge = FR;
+    int otherEdge = UR;
+    int left = 4;
+    for (int j = 0; j < 12; ++j) {
+        if (left > 0 && slice - binomial(11 - j, left) >= 0) {
+            slice -= binomial(11 - j, left);
+            ep[j] = sliceEdge++;
+            --left;
+        } else {
+            ep[j] = otherEdge++;
+        }
+    }
+}
+
+int CubieCube::sliceSorted() const
+{
+    int slice = 0;
+    int found = 0;
+    uint8_t order[4];
+    for (int j = 11; j >= 0; --j) {
+        if (ep[j] >= FR) {
+            slice += binomial(11 - j, found + 1);
+            order[3 - found] = ep[j] - FR;
+            ++found;
+        }
+    }
+    return slice * 24 + permutationRank(order, 4);
+}
+
+void CubieCube::setSliceSorted(int sliceSorted)
+{
+    setSlice(sliceSorted / 24);
+    uint8_t order[4];
+    permutationUnrank(sliceSorted % 24, order, 4);
+    int k = 0;
+    for (int j = 0; j < 12; ++j) {
+        if (ep[j] >= FR) {
+            ep[j] = FR + order[k++];
+        }
+    }
+}
+
+int CubieCube::cornerPerm() const
+{
+    return permutationRank(cp, 8);
+}
+
+void CubieCube::setCornerPerm(int perm)
+{
+    permutationUnrank(perm, cp, 8);
+}
+
+int CubieCube::edgePerm() const
+{
+    return permutationRank(ep, 8);
+}
+
+void CubieCube::setEdgePerm(int perm)
+{
+    permutationUnrank(perm, ep, 8);
+}
+
+int CubieCube::slicePerm() const
+{
+    uint8_t perm[4];
+    for (int i = 0; i < 4; ++i) {
+        perm[i] = ep[FR + i] - FR;
+    }
+    return permutationRank(perm, 4);
+}
+
+void CubieCube::setSlicePerm(int perm)
+{
+    uint8_t slice[4];
+    permutationUnrank(perm, slice, 4);
+    for (int i = 0; i < 4; ++i) {
+        ep[FR + i] = slice[i] + FR;
+    }
+}
+
+int permutationRank(const uint8_t *perm, int n)
+{
+    int rank = 0;
+    for (int i = 0; i < n; ++i) {
+        int smaller = 0;
+        for (int j = i + 1; j < n; ++j) {
+            if (perm[j] < perm[i]) {
+                ++smaller;
+            }
+        }
+        rank = rank * (n - i) + smaller;
+    }
+    return rank;
+}
+
+void permutationUnrank(int rank, uint8_t *perm, int n)
+{
+    uint8_t digits[12];
+    for (int i = n - 1; i >= 0; --i) {
+        digits[i] = rank % (n - i);
+        rank /= n - i;
+    }
+
+    bool used[12] = {};
+    for (int i = 0; i < n; ++i) {
+        int skip = digits[i];
+        for (int value = 0; value < n; ++value) {
+            if (used[value]) {
+                continue;
+            }
+            if (skip-- == 0) {
+                perm[i] = value;
+                used[value] = true;
+                break;
+            }
+        }
+    }
+}
+
+int binomial(int n, int k)
+{
+    if (k < 0 || k > n) {
+        return 0;
+    }
+    int result = 1;
+    for (int i = 1; i <= k; ++i) {
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
+
+namespace {
+
+struct Symmetries {
+    Symmetries();
+
+    CubieCube cubes[symmetryCount];
+    int inverses[symmetryCount];
+};
+
+CubieCube makeCube(const uint8_t (&cp)[8], const uint8_t (&co)[8], const uint8_t (&ep)[12], const uint8_t (&eo)[12])
+{
+    CubieCube cube;
+    std::memcpy(cube.cp, cp, 8);
+    std::memcpy(cube.co, co, 8);
+    std::memcpy(cube.ep, ep, 12);
+    std::memcpy(cube.eo, eo, 12);
+    return cube;
+}
+
+Symmetries::Symmetries()
+{
+    // 120 degrees around the URF-DBL diagonal, 180 degrees around the F-B
+    // axis, 90 degrees around the U-D axis and the reflection through the
+    // R-L plane
+    const CubieCube rotURF3 = makeCube({ URF, DFR, DLF, UFL, UBR, DRB, DBL, ULB }, { 1, 2, 1, 2, 2, 1, 2, 1 },
+                                       { UF, FR, DF, FL, UB, BR, DB, BL, UR, DR, DL, UL }, { 1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1 });
+    const CubieCube rotF2 = makeCube({ DLF, DFR, DRB, DBL, UFL, URF, UBR, ULB }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+                                     { DL, DF, DR, DB, UL, UF, UR, UB, FL, FR, BR, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 });
+    const CubieCube rotU4 = makeCube({ UBR, URF, UFL, ULB, DRB, DFR, DLF, DBL }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+                                     { UB, UR, UF, UL, DB, DR, DF, DL, BR, FR, FL, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1 });
+    const CubieCube mirrorLR = makeCube({ UFL, URF, UBR, ULB, DLF, DFR, DRB, DBL }, { 3, 3, 3, 3, 3, 3, 3, 3 },
+                                        { UL, UF, UR, UB, DL, DF, DR, DB, FL, FR, BR, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 });
+
+    CubieCube cube;
+    int sym = 0;
+    for (int urf3 = 0; urf3 < 3; ++urf3) {
+        for (int f2 = 0; f2 < 2; ++f2) {
+            for (int u4 = 0; u4 < 4; ++u4) {
+                for (int lr2 = 0; lr2 < 2; ++lr2) {
+                    cubes[sym++] = cube;
+                    cube.multiply(mirrorLR);
+                }
+                cube.multiply(rotU4);
+            }
+            cube.multiply(rotF2);
+        }
+        cube.multiply(rotURF3);
+    }
+
+    for (int i = 0; i < symmetryCount; ++i) {
+        for (int j = 0; j < symmetryCount; ++j) {
+            CubieCube product = cubes[i];
+            product.multiply(cubes[j]);
+            if (product == CubieCube()) {
+                inverses[i] = j;
+            }
+        }
+    }
+}
+
+const Symmetries &symmetries()
+{
+    static const Symmetries table;
+    return table;
+}
+
+} // namespace
+
+const CubieCube &symmetryCube(int sym)
+{
+    return symmetries().cubes[sym];
+}
+
+int symmetryInverse(int sym)
+{
+    return symmetries().inverses[sym];
+}
+
+CubieCube conjugate(const CubieCube &cube, int sym)
+{
+    CubieCube result = symmetries().cubes[sym];
+    result.multiply(cube);
+    result.multiply(symmetries().cubes[symmetries().inverses[sym]]);
+    return result;
+}
@@ -0,0 +1,76 @@
+#ifndef CUBIECUBE_H
+#define CUBIECUBE_H
+
+#include <cstdint>
+
+#include "cubestate.h"
+
+// Cubie representation with separate permutation and orientation arrays.
+// The solvers define their coordinates on it; it always lives in the
+// centers' frame, so only the 18 face turns apply.
+struct CubieCube
+{
+    CubieCube();
+    explicit CubieCube(const CubeState &state);
+
+    void turn(int move);
+
+    // this * other, i.e. other applied after this. Corner orientations of
+    // 3..5 mark mirrored cubes, which only the symmetries use.
+    void multiply(const CubieCube &other);
+    CubieCube inverse() const;
+
+    bool operator==(const CubieCube &other) const;
+
+    // Corner orientations, 0..2186
+    int twist() const;
+    void setTwist(int twist);
+
+    // Edge orientations, 0..2047
+    int flip() const;
+    void setFlip(int flip);
+
+    // Positions of the four E-slice edges, 0..494 (0 when they are home)
+    int slice() const;
+    void setSlice(int slice);
+
+    // slice() * 24 plus the order of the E-slice edges, 0..11879; below 24
+    // it equals slicePerm()
+    int sliceSorted() const;
+    void setSliceSorted(int sliceSorted);
+
+    // Corner permutation, 0..40319
+    int cornerPerm() const;
+    void setCornerPerm(int perm);
+
+    // Permutation of the eight U and D edges while they stay in the U and D layers
+    int edgePerm() const;
+    void setEdgePerm(int perm);
+
+    // Permutation of the E-slice edges while they stay in the slice, 0..23
+    int slicePerm() const;
+    void setSlicePerm(int perm);
+
+    uint8_t cp[8];
+    uint8_t co[8];
+    uint8_t ep[12];
+    uint8_t eo[12];
+};
+
+// Lehmer rank of a permutation of 0..n-1 (0 for the identity) and its inverse
+int permutationRank(const uint8_t *perm, int n);
+void permutationUnrank(int rank, uint8_t *perm, int n);
+
+int binomial(int n, int k);
+
+// Symmetries of the cube; the first 16 keep the U-D axis in place
+constexpr int symmetryCount = 48;
+constexpr int symmetryCountUD = 16;
+
+const CubieCube &symmetryCube(int sym);
+int symmetryInverse(int sym);
+
+// symmetryCube(sym) * cube * symmetryCube(sym)^-1
+CubieCube conjugate(const CubieCube &cube, int sym);
+
+#endif // CUBIECUBE_H
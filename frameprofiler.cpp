@@ -0,0 +1,202 @@
+#include "frameprofiler.h"
+
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+
+constexpr int gpuQueryCount = 4;
+
+const double reportedFractions[] = { 0.5, 0.9, 0.99, 1.0 };
+const char *const reportedNames[] = { "p50", "p90", "p99", "max" };
+
+double milliseconds(qint64 nanoseconds)
+{
+    return nanoseconds / 1e6;
+}
+
+} // namespace
+
+const char *const FrameProfiler::columnNames[ColumnCount] = {
+    "interval_ms", "view_setup_ms", "cubies_ms", "submission_ms", "cpu_ms", "gpu_ms"
+};
+
+FrameProfiler::FrameProfiler()
+    : frames(frameCapacity)
+{
+    clock.start();
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    for (GpuQuery &query : gpuQueries) {
+        delete query.query;
+    }
+}
+
+void FrameProfiler::initializeGpu()
+{
+    for (int i = 0; i < gpuQueryCount; ++i) {
+        QOpenGLTimerQuery *query = new QOpenGLTimerQuery();
+        if (!query->create()) {
+            delete query;
+            return;
+        }
+        gpuQueries.push_back({ query, -1 });
+    }
+}
+
+void FrameProfiler::destroyGpu()
+{
+    for (GpuQuery &query : gpuQueries) {
+        query.query->destroy();
+        delete query.query;
+    }
+    gpuQueries.clear();
+    runningQuery = nullptr;
+}
+
+void FrameProfiler::beginFrame()
+{
+    frameStart = clock.nsecsElapsed();
+    sectionStart = frameStart;
+
+    Frame &frame = frames[framesRecorded % frameCapacity];
+    frame.fill(0.0);
+    frame[Interval] = previousFrameStart >= 0 ? milliseconds(frameStart - previousFrameStart) : -1.0;
+    frame[Gpu] = -1.0;
+    previousFrameStart = frameStart;
+
+    collectGpuResults();
+    for (GpuQuery &query : gpuQueries) {
+        if (query.frameNumber < 0) {
+            query.frameNumber = framesRecorded;
+            query.query->begin();
+            runningQuery = &query;
+            break;
+        }
+    }
+}
+
+void FrameProfiler::endSection(Column section)
+{
+    qint64 now = clock.nsecsElapsed();
+    frames[framesRecorded % frameCapacity][section] = milliseconds(now - sectionStart);
+    sectionStart = now;
+}
+
+void FrameProfiler::endFrame()
+{
+    if (runningQuery) {
+        runningQuery->query->end();
+        runningQuery = nullptr;
+    }
+    frames[framesRecorded % frameCapacity][Cpu] = milliseconds(clock.nsecsElapsed() - frameStart);
+    ++framesRecorded;
+}
+
+void FrameProfiler::collectGpuResults()
+{
+    for (GpuQuery &query : gpuQueries) {
+        if (query.frameNumber < 0 || !query.query->isResultAvailable()) {
+            continue;
+        }
+        quint64 elapsed = query.query->waitForResult();
+        // Frames that have left the ring are dropped
+        if (query.frameNumber >= framesRecorded - frameCapacity) {
+            frames[query.frameNumber % frameCapacity][Gpu] = milliseconds(qint64(elapsed));
+        }
+        query.frameNumber = -1;
+    }
+}
+
+int FrameProfiler::frameCount() const
+{
+    return int(std::min<qint64>(framesRecorded, frameCapacity));
+}
+
+const FrameProfiler::Frame &FrameProfiler::frame(int index) const
+{
+    return frames[(framesRecorded - frameCount() + index) % frameCapacity];
+}
+
+double FrameProfiler::percentile(Column column, double fraction) const
+{
+    std::vector<double> values;
+    values.reserve(frameCount());
+    for (int i = 0; i < frameCount(); ++i) {
+        if (frame(i)[column] >= 0.0) {
+            values.push_back(frame(i)[column]);
+        }
+    }
+    if (values.empty()) {
+        return 0.0;
+    }
+    // Nearest rank
+    size_t rank = std::min(values.size() - 1, size_t(fraction * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+QString FrameProfiler::overlayText() const
+{
+    if (frameCount() == 0) {
+        return QString();
+    }
+    const Frame &last = frame(frameCount() - 1);
+    double interval = percentile(Interval, 0.5);
+    QString text = QString("%1 frames, %2 fps (median interval)\n")
+                       .arg(frameCount())
+                       .arg(interval > 0.0 ? 1000.0 / interval : 0.0, 0, 'f', 1);
+    text += QString("%1 %2 %3 %4\n").arg("", -14).arg("last", 7).arg("p50", 7).arg("p99", 7);
+    for (int column = 0; column < ColumnCount; ++column) {
+        text += QString("%1 %2 %3 %4\n")
+                    .arg(columnNames[column], -14)
+                    .arg(last[column], 7, 'f', 3)
+                    .arg(percentile(Column(column), 0.5), 7, 'f', 3)
+                    .arg(percentile(Column(column), 0.99), 7, 'f', 3);
+    }
+    return text;
+}
+
+bool FrameProfiler::writeCsv(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+
+    out << "frame";
+    for (int column = 0; column < ColumnCount; ++column) {
+        out << ',' << columnNames[column];
+    }
+    out << '\n';
+
+    // Values not measured are left empty
+    qint64 first = framesRecorded - frameCount();
+    for (int i = 0; i < frameCount(); ++i) {
+        out << first + i;
+        for (int column = 0; column < ColumnCount; ++column) {
+            out << ',';
+            if (frame(i)[column] >= 0.0) {
+                out << QString::number(frame(i)[column], 'f', 4);
+            }
+        }
+        out << '\n';
+    }
+
+    // Summary rows, labelled in the frame column
+    for (size_t row = 0; row < std::size(reportedFractions); ++row) {
+        out << reportedNames[row];
+        for (int column = 0; column < ColumnCount; ++column) {
+            out << ',' << QString::number(percentile(Column(column), reportedFractions[row]), 'f', 4);
+        }
+        out << '\n';
+    }
+
+    out.flush();
+    return file.commit();
+}
@@ -0,0 +1,77 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QOpenGLTimerQuery>
+#include <QString>
+
+#include <array>
+#include <vector>
+
+// Times the parts of paintGL on the CPU, the GPU work of each frame with
+// timer queries, and the interval between frames. The last frameCapacity
+// frames are kept for the overlay and the CSV export. All times are in
+// milliseconds, negative where nothing was measured.
+class FrameProfiler
+{
+public:
+    enum Column {
+        Interval,       // since the previous frame began, none for the first
+        ViewSetup,      // clearing, orientation and view matrix
+        Cubies,         // turn animations and cubie models
+        Submission,     // the draw call
+        Cpu,            // the whole frame
+        Gpu,            // none until the query result has arrived
+        ColumnCount
+    };
+    typedef std::array<double, ColumnCount> Frame;
+
+    static const char *const columnNames[ColumnCount];
+    static constexpr int frameCapacity = 1000;
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    // Need a current context. Without timer query support only the CPU
+    // side is measured.
+    void initializeGpu();
+    void destroyGpu();
+
+    void beginFrame();
+    // The section ran from the end of the one before, or the frame's
+    // beginning, until now
+    void endSection(Column section);
+    void endFrame();
+
+    int frameCount() const;
+    // 0 is the oldest frame kept
+    const Frame &frame(int index) const;
+
+    // Over the frames kept that have a value in the column, 0 if none do
+    double percentile(Column column, double fraction) const;
+
+    QString overlayText() const;
+    bool writeCsv(const QString &path) const;
+
+private:
+    struct GpuQuery {
+        QOpenGLTimerQuery *query;
+        qint64 frameNumber;     // -1 while the query is free
+    };
+
+    void collectGpuResults();
+
+    std::vector<Frame> frames;
+    qint64 framesRecorded = 0;
+
+    QElapsedTimer clock;
+    qint64 frameStart = -1;
+    qint64 sectionStart = 0;
+    qint64 previousFrameStart = -1;
+
+    // A few frames in flight, so reading a result never stalls the pipeline
+    std::vector<GpuQuery> gpuQueries;
+    GpuQuery *runningQuery = nullptr;
+};
+
+#endif // FRAMEPROFILER_H
@@ -1,8 +1,11 @@
 #include "history.h"
 #include "ui_history.h"
 
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
-#include <QTextStream>
+#include <QHeaderView>
 
 History::History(QWidget *parent)
     : QDialog(parent)
@@ -11,15 +14,30 @@ History::History(QWidget *parent)
     ui->setupUi(this);
     setWindowTitle("History of solutions");
 
-    ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-    ui->tableWidget->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-    ui->tableWidget->resizeColumnsToContents();
-    ui->tableWidget->resizeRowsToContents();
-    ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    connect(ui->clear_history_btn, SIGNAL(clicked()), this, SLOT(clearHistory()));
+    connect(ui->replay_btn, SIGNAL(clicked()), this, SLOT(replaySelected()));
 
-    ui->tableWidget->show();
+    bool firstRun = !QFile::exists(HistoryLog::defaultPath());
+    if (log.open(HistoryLog::defaultPath()) && firstRun) {
+        importTextHistory();
+    }
 
-    connect(ui->clear_history_btn, SIGNAL(clicked()), this, SLOT(clearHistory()));
+    model = new HistoryModel(&log, this);
+    ui->tableView->setModel(model);
+
+    // Nothing may size itself to its contents: that would read every row
+    QHeaderView *rowsHeader = ui->tableView->verticalHeader();
+    rowsHeader->setSectionResizeMode(QHeaderView::Fixed);
+    rowsHeader->setDefaultSectionSize(ui->tableView->fontMetrics().height() + 8);
+    QHeaderView *columnsHeader = ui->tableView->horizontalHeader();
+    columnsHeader->setSectionResizeMode(QHeaderView::Interactive);
+    columnsHeader->setSectionResizeMode(HistoryModel::ScrambleColumn, QHeaderView::Stretch);
+    columnsHeader->setSectionResizeMode(HistoryModel::SolutionColumn, QHeaderView::Stretch);
+    ui->tableView->setWordWrap(false);
+    ui->tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    ui->tableView->sortByColumn(HistoryModel::DateColumn, Qt::AscendingOrder);
+    ui->tableView->setSortingEnabled(true);
 }
 
 History::~History()
@@ -27,60 +45,52 @@ History::~History()
     delete ui;
 }
 
-void History::addRow(QString time, QString scramble, QString solution)
+void History::addSolve(qint64 duration, int cubeSize, QString scramble, QString solution)
 {
-    int row = ui->tableWidget->rowCount();
-    ui->tableWidget->insertRow(row);
-
-    QTableWidgetItem *item = new QTableWidgetItem(time);
-    ui->tableWidget->setItem(row, 0, item);
-
-    item = new QTableWidgetItem(scramble);
-    ui->tableWidget->setItem(row, 1, item);
-
-    item = new QTableWidgetItem(solution);
-    ui->tableWidget->setItem(row, 2, item);
-
-    ui->tableWidget->show();
+    HistoryLog::Solve solve;
+    solve.timestamp = QDateTime::currentMSecsSinceEpoch();
+    solve.duration = duration;
+    solve.cubeSize = cubeSize;
+    solve.scramble = scramble;
+    solve.solution = solution;
+    if (log.append(solve)) {
+        model->solveAdded();
+    }
 }
 
-void History::addInfoToFile(QString time, QString scramble, QString solution)
+void History::showHistory()
 {
-    QFile file("C:/Users/Dima/Documents/Rubik-s-Cube-Course-Project/history.txt");
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
-        return;
-
-    QTextStream out(&file);
-    out << time << "\n" << scramble << "\n" << solution << "\n";
-    file.close();
+    ui->tableView->scrollToBottom();
 }
 
-void History::showHistory()
+void History::importTextHistory()
 {
-    QFile file("C:/Users/Dima/Documents/Rubik-s-Cube-Course-Project/history.txt");
-    if (!file.open(QIODevice::ReadOnly))
-        return;
+    // Next to the executable, or where the first versions kept it
+    const QString paths[] = {
+        QDir(QCoreApplication::applicationDirPath()).filePath("history.txt"),
+        "C:/Users/Dima/Documents/Rubik-s-Cube-Course-Project/history.txt"
+    };
+    for (const QString &path : paths) {
+        if (QFile::exists(path)) {
+            log.importText(path);
+            return;
+        }
+    }
+}
 
-    QTextStream in(&file);
-    while (!in.atEnd())
-    {
-        QString time = in.readLine();
-        QString scramble = in.readLine();
-        QString solution = in.readLine();
-        addRow(time, scramble, solution);
+void History::replaySelected()
+{
+    QModelIndex current = ui->tableView->currentIndex();
+    if (current.isValid()) {
+        emit replayRequested(model->logIndex(current.row()));
     }
-    file.close();
 }
 
 void History::clearHistory()
 {
-    for (int i = 0; i < ui->tableWidget->rowCount(); i++)
-    {
-        ui->tableWidget->removeRow(i);
-    }
-    ui->tableWidget->setRowCount(0);
-    QFile file("C:/Users/Dima/Documents/Rubik-s-Cube-Course-Project/history.txt");
-    file.remove();
+    log.clear();
+    model->reload();
+    emit historyCleared();
 }
 
 
@@ -3,6 +3,9 @@
 
 #include <QDialog>
 
+#include "historylog.h"
+#include "historymodel.h"
+
 namespace Ui {
 class History;
 }
@@ -15,17 +18,31 @@ public:
     explicit History(QWidget *parent = nullptr);
     ~History();
 
-public slots:
-    void addRow(QString time, QString scramble, QString solution);
+    const HistoryLog &getLog() const { return log; }
 
-    void addInfoToFile(QString time, QString scramble, QString solution);
+public slots:
+    // Saves a solve of duration ms that ended now
+    void addSolve(qint64 duration, int cubeSize, QString scramble, QString solution);
 
+    // Scrolls to the bottom, where the newest solves are unless sorted
+    // otherwise
     void showHistory();
 
     void clearHistory();
 
+    void replaySelected();
+
+signals:
+    void historyCleared();
+    void replayRequested(int logIndex);
+
 private:
+    // Brings in the history.txt of earlier versions when there is no log yet
+    void importTextHistory();
+
     Ui::History *ui;
+    HistoryLog log;
+    HistoryModel *model;
 };
 
 #endif // HISTORY_H
@@ -0,0 +1,334 @@
+#include "historylog.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTextStream>
+#include <QTime>
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "notation.h"
+
+namespace {
+
+constexpr char recordsMagic[8] = { 'C', 'U', 'B', 'E', 'H', 'I', 'S', '\0' };
+constexpr char indexMagic[8] = { 'C', 'U', 'B', 'E', 'I', 'D', 'X', '\0' };
+constexpr quint32 formatVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 reserved;
+};
+
+enum RecordFlag {
+    ScrambleText = 1,
+    SolutionText = 2
+};
+
+constexpr int bitsPerMove = 5;
+
+qint64 packedSize(quint32 moves)
+{
+    return (qint64(moves) * bitsPerMove + 7) / 8;
+}
+
+// A scramble or a solution as it is stored
+struct Sequence {
+    QByteArray bytes;
+    quint32 size;       // moves when packed, bytes when text
+    int moves;
+    bool text;
+};
+
+// Face turns are packed lowest bits first, anything else is UTF-8
+Sequence encode(const QString &text, bool packable)
+{
+    Sequence sequence;
+    std::vector<Move> moves;
+    bool faceTurns = packable && parseMoves(text.toStdString(), moves);
+    for (size_t i = 0; faceTurns && i < moves.size(); ++i) {
+        faceTurns = moves[i] < faceTurnCount;
+    }
+    if (!faceTurns) {
+        sequence.bytes = text.toUtf8();
+        sequence.size = quint32(sequence.bytes.size());
+        sequence.moves = text.split(' ', Qt::SkipEmptyParts).size();
+        sequence.text = true;
+        return sequence;
+    }
+
+    sequence.bytes.fill('\0', packedSize(quint32(moves.size())));
+    for (size_t i = 0; i < moves.size(); ++i) {
+        size_t bit = i * bitsPerMove;
+        unsigned value = unsigned(moves[i]) << (bit % 8);
+        sequence.bytes[int(bit / 8)] = char(uchar(sequence.bytes[int(bit / 8)]) | (value & 0xff));
+        if (value > 0xff) {
+            sequence.bytes[int(bit / 8 + 1)] = char(uchar(sequence.bytes[int(bit / 8 + 1)]) | (value >> 8));
+        }
+    }
+    sequence.size = quint32(moves.size());
+    sequence.moves = int(moves.size());
+    sequence.text = false;
+    return sequence;
+}
+
+QString decode(const uchar *data, quint32 size, bool text)
+{
+    if (text) {
+        return QString::fromUtf8(reinterpret_cast<const char *>(data), int(size));
+    }
+    std::vector<Move> moves(size);
+    for (quint32 i = 0; i < size; ++i) {
+        size_t bit = size_t(i) * bitsPerMove;
+        unsigned value = data[bit / 8] >> (bit % 8);
+        if (bit % 8 > 8 - bitsPerMove) {
+            value |= unsigned(data[bit / 8 + 1]) << (8 - bit % 8);
+        }
+        moves[i] = Move(value & ((1u << bitsPerMove) - 1));
+    }
+    return QString::fromStdString(formatMoves(moves));
+}
+
+qint64 storedSize(quint32 size, bool text)
+{
+    return text ? qint64(size) : packedSize(size);
+}
+
+// Opens a file for reading and appending, giving it a header if it is new
+bool openFile(QFile &file, const char *magic)
+{
+    if (!file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+    if (file.size() == 0) {
+        FileHeader header = {};
+        std::memcpy(header.magic, magic, sizeof(header.magic));
+        header.formatVersion = formatVersion;
+        return file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header))
+            && file.flush();
+    }
+    FileHeader header;
+    return file.read(reinterpret_cast<char *>(&header), sizeof(header)) == qint64(sizeof(header))
+        && std::memcmp(header.magic, magic, sizeof(header.magic)) == 0
+        && header.formatVersion == formatVersion;
+}
+
+} // namespace
+
+HistoryLog::~HistoryLog()
+{
+    close();
+}
+
+QString HistoryLog::defaultPath()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("history.bin");
+}
+
+bool HistoryLog::open(const QString &path)
+{
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    records.setFileName(path);
+    index.setFileName(path + ".idx");
+    if (!openFile(records, recordsMagic) || !openFile(index, indexMagic)) {
+        close();
+        return false;
+    }
+
+    // A solve that was being saved when the program stopped may have left
+    // part of an index entry behind; the next one goes in its place
+    qint64 entries = (index.size() - qint64(sizeof(FileHeader))) / qint64(sizeof(quint64));
+    if (!index.resize(sizeof(FileHeader) + entries * sizeof(quint64))) {
+        close();
+        return false;
+    }
+    if (!remap()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void HistoryLog::close()
+{
+    unmap();
+    records.close();
+    index.close();
+    recordCount = 0;
+}
+
+bool HistoryLog::remap()
+{
+    unmap();
+    recordsSize = records.size();
+    recordsData = records.map(0, recordsSize);
+    qint64 indexSize = index.size();
+    indexData = index.map(0, indexSize);
+    if (!recordsData || !indexData) {
+        unmap();
+        return false;
+    }
+
+    // Records are written before their index entries, so only an entry
+    // that never saw its record completed can point past the end
+    recordCount = int((indexSize - qint64(sizeof(FileHeader))) / qint64(sizeof(quint64)));
+    while (recordCount > 0) {
+        quint64 last = offset(recordCount - 1);
+        if (last >= sizeof(FileHeader) && qint64(last + sizeof(RecordHeader)) <= recordsSize) {
+            RecordHeader lastHeader = header(recordCount - 1);
+            qint64 end = qint64(last + sizeof(RecordHeader))
+                + storedSize(lastHeader.scrambleSize, lastHeader.flags & ScrambleText)
+                + storedSize(lastHeader.solutionSize, lastHeader.flags & SolutionText);
+            if (end <= recordsSize) {
+                break;
+            }
+        }
+        --recordCount;
+    }
+    return true;
+}
+
+void HistoryLog::unmap()
+{
+    if (recordsData) {
+        records.unmap(const_cast<uchar *>(recordsData));
+        recordsData = nullptr;
+    }
+    if (indexData) {
+        index.unmap(const_cast<uchar *>(indexData));
+        indexData = nullptr;
+    }
+    recordsSize = 0;
+}
+
+quint64 HistoryLog::offset(int index) const
+{
+    quint64 value;
+    std::memcpy(&value, indexData + sizeof(FileHeader) + size_t(index) * sizeof(quint64), sizeof(value));
+    return value;
+}
+
+HistoryLog::RecordHeader HistoryLog::header(int index) const
+{
+    RecordHeader value;
+    std::memcpy(&value, recordsData + offset(index), sizeof(value));
+    return value;
+}
+
+HistoryLog::Solve HistoryLog::solve(int index) const
+{
+    RecordHeader recordHeader = header(index);
+    const uchar *scramble = recordsData + offset(index) + sizeof(RecordHeader);
+    const uchar *solution = scramble + storedSize(recordHeader.scrambleSize, recordHeader.flags & ScrambleText);
+
+    Solve result;
+    result.timestamp = recordHeader.timestamp;
+    result.duration = recordHeader.duration;
+    result.cubeSize = recordHeader.cubeSize;
+    result.scramble = decode(scramble, recordHeader.scrambleSize, recordHeader.flags & ScrambleText);
+    result.solution = decode(solution, recordHeader.solutionSize, recordHeader.flags & SolutionText);
+    return result;
+}
+
+qint64 HistoryLog::timestamp(int index) const
+{
+    return header(index).timestamp;
+}
+
+qint64 HistoryLog::duration(int index) const
+{
+    return header(index).duration;
+}
+
+int HistoryLog::solutionLength(int index) const
+{
+    return header(index).solutionMoves;
+}
+
+bool HistoryLog::append(const Solve &solve)
+{
+    bool appended = appendRecord(solve);
+    return remap() && appended;
+}
+
+bool HistoryLog::appendRecord(const Solve &solve)
+{
+    if (!isOpen()) {
+        return false;
+    }
+    Sequence scramble = encode(solve.scramble, solve.cubeSize == 3);
+    Sequence solution = encode(solve.solution, solve.cubeSize == 3);
+
+    RecordHeader recordHeader = {};
+    recordHeader.timestamp = solve.timestamp;
+    recordHeader.duration = quint32(qBound<qint64>(0, solve.duration, std::numeric_limits<quint32>::max()));
+    recordHeader.scrambleSize = scramble.size;
+    recordHeader.solutionSize = solution.size;
+    recordHeader.solutionMoves = quint16(qMin(solution.moves, 65535));
+    recordHeader.cubeSize = quint8(solve.cubeSize);
+    recordHeader.flags = (scramble.text ? ScrambleText : 0) | (solution.text ? SolutionText : 0);
+
+    QByteArray record(reinterpret_cast<const char *>(&recordHeader), sizeof(recordHeader));
+    record.reserve(record.size() + scramble.bytes.size() + solution.bytes.size());
+    record += scramble.bytes;
+    record += solution.bytes;
+
+    // The record first, so the index never points at half of one
+    quint64 recordOffset = quint64(records.size());
+    if (!records.seek(qint64(recordOffset)) || records.write(record) != record.size() || !records.flush()) {
+        return false;
+    }
+    qint64 entryOffset = sizeof(FileHeader) + qint64(recordCount) * qint64(sizeof(quint64));
+    if (!index.seek(entryOffset)
+            || index.write(reinterpret_cast<const char *>(&recordOffset), sizeof(recordOffset)) != qint64(sizeof(recordOffset))
+            || !index.flush()) {
+        return false;
+    }
+    ++recordCount;
+    return true;
+}
+
+bool HistoryLog::clear()
+{
+    if (!isOpen()) {
+        return false;
+    }
+    // Mapped files cannot be truncated everywhere
+    unmap();
+    bool cleared = records.resize(sizeof(FileHeader)) && index.resize(sizeof(FileHeader));
+    return remap() && cleared;
+}
+
+int HistoryLog::importText(const QString &path)
+{
+    QFile file(path);
+    if (!isOpen() || !file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+
+    QTextStream in(&file);
+    int imported = 0;
+    while (!in.atEnd()) {
+        QString time = in.readLine();
+        Solve solve;
+        QTime duration = QTime::fromString(time.trimmed(), "mm:ss");
+        solve.duration = duration.isValid() ? duration.msecsSinceStartOfDay() : 0;
+        solve.scramble = in.readLine();
+        solve.solution = in.readLine();
+        if (time.isEmpty() && solve.scramble.isEmpty()) {
+            continue;
+        }
+        if (!appendRecord(solve)) {
+            break;
+        }
+        ++imported;
+    }
+    remap();
+    return imported;
+}
@@ -0,0 +1,81 @@
+#ifndef HISTORYLOG_H
+#define HISTORYLOG_H
+
+#include <QFile>
+#include <QString>
+
+// Solves kept on disk, one record appended per solve and never rewritten.
+// The records go into one file and their offsets into an index next to it
+// (the same name with ".idx"); both are memory-mapped for reading, so any
+// record is found in constant time however long the history grows.
+// Scrambles and solutions of the 3x3x3 in face turns are packed at 5 bits
+// per move, anything else is kept as text.
+class HistoryLog
+{
+public:
+    struct Solve {
+        qint64 timestamp = 0;   // ms since the epoch in UTC, 0 if not known
+        qint64 duration = 0;    // ms
+        int cubeSize = 3;
+        QString scramble;
+        QString solution;
+    };
+
+    HistoryLog() = default;
+    ~HistoryLog();
+    HistoryLog(const HistoryLog &) = delete;
+    HistoryLog &operator=(const HistoryLog &) = delete;
+
+    // history.bin in the application's data directory
+    static QString defaultPath();
+
+    // Creates the files if they do not exist yet; false if they cannot be
+    // created or hold something else
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return indexData != nullptr; }
+
+    int count() const { return recordCount; }
+    Solve solve(int index) const;
+
+    // From the fixed part of a record, without decoding its moves
+    qint64 timestamp(int index) const;
+    qint64 duration(int index) const;
+    int solutionLength(int index) const;
+
+    bool append(const Solve &solve);
+    // Drops every record
+    bool clear();
+
+    // Appends the solves of the history.txt of earlier versions, three
+    // lines each: the time as mm:ss, the scramble and the solution. Returns
+    // how many were imported, -1 if the file cannot be read.
+    int importText(const QString &path);
+
+private:
+    struct RecordHeader {
+        qint64 timestamp;
+        quint32 duration;
+        quint32 scrambleSize;       // moves when packed, bytes when text
+        quint32 solutionSize;
+        quint16 solutionMoves;      // up to 65535
+        quint8 cubeSize;
+        quint8 flags;
+    };
+
+    bool appendRecord(const Solve &solve);
+    bool remap();
+    void unmap();
+
+    quint64 offset(int index) const;
+    RecordHeader header(int index) const;
+
+    QFile records;
+    QFile index;
+    const uchar *recordsData = nullptr;
+    qint64 recordsSize = 0;
+    const uchar *indexData = nullptr;
+    int recordCount = 0;
+};
+
+#endif // HISTORYLOG_H
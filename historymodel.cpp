@@ -0,0 +1,193 @@
+#include "historymodel.h"
+
+#include <QDateTime>
+#include <QTime>
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+// A few screens of rows
+constexpr int cachedSolves = 512;
+
+const char *const columnNames[HistoryModel::ColumnCount] = {
+    "Date", "Time", "Moves", "Scramble", "Solution"
+};
+
+} // namespace
+
+HistoryModel::HistoryModel(const HistoryLog *log, QObject *parent)
+    : QAbstractTableModel(parent)
+    , log(log)
+    , rows(log->count())
+    , solves(cachedSolves)
+{
+}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+int HistoryModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows) {
+        return QVariant();
+    }
+    if (role == Qt::TextAlignmentRole) {
+        return index.column() == MovesColumn ? int(Qt::AlignRight | Qt::AlignVCenter) : int(Qt::AlignLeft | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    int solveIndex = logIndex(index.row());
+    switch (index.column()) {
+    case DateColumn: {
+        // Solves imported from history.txt have no date
+        qint64 timestamp = log->timestamp(solveIndex);
+        return timestamp > 0 ? QDateTime::fromMSecsSinceEpoch(timestamp).toString("yyyy-MM-dd hh:mm") : QString();
+    }
+    case TimeColumn:
+        return QTime(0, 0).addMSecs(int(log->duration(solveIndex))).toString("mm:ss");
+    case MovesColumn:
+        return log->solutionLength(solveIndex);
+    case ScrambleColumn:
+        return solve(solveIndex)->scramble;
+    case SolutionColumn:
+        return solve(solveIndex)->solution;
+    }
+    return QVariant();
+}
+
+QVariant HistoryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+    return section >= 0 && section < ColumnCount ? QString(columnNames[section]) : QVariant();
+}
+
+void HistoryModel::sort(int column, Qt::SortOrder order)
+{
+    beginResetModel();
+    sortColumn = column;
+    sortOrder = order;
+    if (ordering(column) && ordering(column)->empty()) {
+        buildOrdering(column);
+    }
+    endResetModel();
+}
+
+void HistoryModel::solveAdded()
+{
+    int added = rows;
+    if (added >= log->count()) {
+        return;
+    }
+
+    // Equal keys keep the saving order, like the full sort does
+    int positions[ColumnCount];
+    for (int column : { TimeColumn, MovesColumn }) {
+        std::vector<int> &indices = column == TimeColumn ? byDuration : byLength;
+        if (indices.empty() && rows > 0) {
+            positions[column] = -1;     // built when sorted by
+            continue;
+        }
+        auto position = column == TimeColumn
+            ? std::upper_bound(indices.begin(), indices.end(), log->duration(added), [this](qint64 value, int i) {
+                  return value < log->duration(i);
+              })
+            : std::upper_bound(indices.begin(), indices.end(), log->solutionLength(added), [this](int value, int i) {
+                  return value < log->solutionLength(i);
+              });
+        positions[column] = int(position - indices.begin());
+    }
+
+    int position = ordering(sortColumn) ? positions[sortColumn] : added;
+    int row = sortOrder == Qt::AscendingOrder ? position : rows - position;
+    beginInsertRows(QModelIndex(), row, row);
+    for (int column : { TimeColumn, MovesColumn }) {
+        if (positions[column] >= 0) {
+            std::vector<int> &indices = column == TimeColumn ? byDuration : byLength;
+            indices.insert(indices.begin() + positions[column], added);
+        }
+    }
+    ++rows;
+    endInsertRows();
+}
+
+void HistoryModel::reload()
+{
+    beginResetModel();
+    rows = log->count();
+    byDuration.clear();
+    byLength.clear();
+    solves.clear();
+    if (ordering(sortColumn)) {
+        buildOrdering(sortColumn);
+    }
+    endResetModel();
+}
+
+const std::vector<int> *HistoryModel::ordering(int column) const
+{
+    switch (column) {
+    case TimeColumn:
+        return &byDuration;
+    case MovesColumn:
+        return &byLength;
+    default:
+        return nullptr;
+    }
+}
+
+void HistoryModel::buildOrdering(int column)
+{
+    std::vector<int> &indices = column == TimeColumn ? byDuration : byLength;
+    indices.resize(rows);
+    std::iota(indices.begin(), indices.end(), 0);
+    if (column == TimeColumn) {
+        std::vector<qint64> durations(rows);
+        for (int i = 0; i < rows; ++i) {
+            durations[i] = log->duration(i);
+        }
+        std::stable_sort(indices.begin(), indices.end(), [&durations](int a, int b) {
+            return durations[a] < durations[b];
+        });
+    } else {
+        std::vector<int> lengths(rows);
+        for (int i = 0; i < rows; ++i) {
+            lengths[i] = log->solutionLength(i);
+        }
+        std::stable_sort(indices.begin(), indices.end(), [&lengths](int a, int b) {
+            return lengths[a] < lengths[b];
+        });
+    }
+}
+
+int HistoryModel::logIndex(int row) const
+{
+    int position = sortOrder == Qt::AscendingOrder ? row : rows - 1 - row;
+    const std::vector<int> *indices = ordering(sortColumn);
+    return indices ? (*indices)[position] : position;
+}
+
+const HistoryLog::Solve *HistoryModel::solve(int logIndex) const
+{
+    HistoryLog::Solve *cached = solves.object(logIndex);
+    if (!cached) {
+        cached = new HistoryLog::Solve(log->solve(logIndex));
+        solves.insert(logIndex, cached);
+    }
+    return cached;
+}
@@ -0,0 +1,64 @@
+#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+
+#include <vector>
+
+#include "historylog.h"
+
+// Rows of a HistoryLog, decoded only when a view asks for them and kept in
+// a small cache, so a view shows a million solves as fast as ten. Sorting
+// by time or by solution length goes through an ordering of the log built
+// once from the fixed parts of the records and kept up to date as solves
+// are added.
+class HistoryModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column {
+        DateColumn,         // also the order the solves were saved in
+        TimeColumn,
+        MovesColumn,
+        ScrambleColumn,
+        SolutionColumn,
+        ColumnCount
+    };
+
+    explicit HistoryModel(const HistoryLog *log, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    // Scramble and solution sort like the date
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Index in the log of the solve shown in a row
+    int logIndex(int row) const;
+
+    // The log has one more solve at its end
+    void solveAdded();
+    // The log has changed in any other way
+    void reload();
+
+private:
+    // Ordering of the log for a column, nullptr for the saving order
+    const std::vector<int> *ordering(int column) const;
+    void buildOrdering(int column);
+    const HistoryLog::Solve *solve(int logIndex) const;
+
+    const HistoryLog *log;
+    int rows = 0;
+
+    int sortColumn = DateColumn;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+    // Log indices by duration and by solution length, empty until needed
+    std::vector<int> byDuration;
+    std::vector<int> byLength;
+
+    mutable QCache<int, HistoryLog::Solve> solves;
+};
+
+#endif // HISTORYMODEL_H
@@ -0,0 +1,255 @@
+#include "layercube.h"
+
+#include <algorithm>
+
+namespace {
+
+// The 24 rotations as signed permutation matrices, with their products
+struct Rotations {
+    int8_t matrix[24][3][3];
+    uint8_t compose[24][24];     // compose[a][b] = a * b, b applied first
+    uint8_t quarter[3];          // +90 degrees around x, y and z
+
+    Rotations()
+    {
+        int count = 1;
+        setIdentity(matrix[0]);
+        for (int axis = 0; axis < 3; ++axis) {
+            int8_t turn[3][3];
+            quarterMatrix(axis, turn);
+            quarter[axis] = find(turn, count);
+        }
+        // Close the set under the three quarter turns
+        for (int i = 0; i < count; ++i) {
+            for (int axis = 0; axis < 3; ++axis) {
+                int8_t turn[3][3];
+                int8_t product[3][3];
+                quarterMatrix(axis, turn);
+                multiply(turn, matrix[i], product);
+                find(product, count);
+            }
+        }
+        for (int a = 0; a < 24; ++a) {
+            for (int b = 0; b < 24; ++b) {
+                int8_t product[3][3];
+                multiply(matrix[a], matrix[b], product);
+                compose[a][b] = find(product, count);
+            }
+        }
+    }
+
+    static void setIdentity(int8_t m[3][3])
+    {
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                m[i][j] = i == j;
+            }
+        }
+    }
+
+    // +90 degrees around axis a takes the next axis b to the one after, c,
+    // and c to -b
+    static void quarterMatrix(int a, int8_t m[3][3])
+    {
+        int b = (a + 1) % 3;
+        int c = (a + 2) % 3;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                m[i][j] = 0;
+            }
+        }
+        m[a][a] = 1;
+        m[c][b] = 1;
+        m[b][c] = -1;
+    }
+
+    static void multiply(const int8_t a[3][3], const int8_t b[3][3], int8_t out[3][3])
+    {
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                out[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+            }
+        }
+    }
+
+    // Index of m, added at the end if it is new
+    int find(const int8_t m[3][3], int &count)
+    {
+        for (int i = 0; i < count; ++i) {
+            if (std::equal(&m[0][0], &m[0][0] + 9, &matrix[i][0][0])) {
+                return i;
+            }
+        }
+        std::copy(&m[0][0], &m[0][0] + 9, &matrix[count][0][0]);
+        return count++;
+    }
+};
+
+const Rotations &rotations()
+{
+    static const Rotations table;
+    return table;
+}
+
+} // namespace
+
+LayerCube::LayerCube(int size)
+    : n(std::clamp(size, minSize, maxSize))
+    , homes(surfaceCount(n))
+    , slotCubie(surfaceCount(n))
+    , orientations(surfaceCount(n), 0)
+{
+    for (int side = 0; side < 6; ++side) {
+        sideColors[side].fill(0);
+        sideColors[side][side] = n * n;
+        uniform[side] = true;
+    }
+    for (int x = 0; x < n; ++x) {
+        for (int y = 0; y < n; ++y) {
+            for (int z = 0; z < n; ++z) {
+                int slot = slotOf(x, y, z);
+                if (slot >= 0) {
+                    homes[slot] = { uint8_t(x), uint8_t(y), uint8_t(z) };
+                    slotCubie[slot] = slot;
+                }
+            }
+        }
+    }
+}
+
+const int8_t *LayerCube::rotationMatrix(int orientation)
+{
+    return &rotations().matrix[orientation][0][0];
+}
+
+int LayerCube::slotOf(int x, int y, int z) const
+{
+    // The x = 0 and x = N - 1 layers whole, then the ring around every
+    // layer in between: the y = 0 row, the y = N - 1 row and the ends of
+    // the rows between them
+    if (x == 0) {
+        return y * n + z;
+    }
+    if (x == n - 1) {
+        return n * n + y * n + z;
+    }
+    int ring = 2 * n * n + (x - 1) * (4 * n - 4);
+    if (y == 0) {
+        return ring + z;
+    }
+    if (y == n - 1) {
+        return ring + n + z;
+    }
+    if (z == 0 || z == n - 1) {
+        return ring + 2 * n + (y - 1) * 2 + (z != 0);
+    }
+    return -1;
+}
+
+template <typename F>
+void LayerCube::forEachInLayer(int axis, int layer, F f) const
+{
+    const int b = (axis + 1) % 3;
+    const int c = (axis + 2) % 3;
+    const bool outer = layer == 0 || layer == n - 1;
+    int p[3];
+    p[axis] = layer;
+    for (int u = 0; u < n; ++u) {
+        p[b] = u;
+        // Inside an inner layer only the ring is on the surface
+        const int step = outer || u == 0 || u == n - 1 ? 1 : n - 1;
+        for (int v = 0; v < n; v += step) {
+            p[c] = v;
+            f(p[0], p[1], p[2]);
+        }
+    }
+}
+
+void LayerCube::turnLayer(int axis, int layer, int quarterTurns, std::vector<int> *moved)
+{
+    quarterTurns = ((quarterTurns % 4) + 4) % 4;
+    if (moved) {
+        moved->clear();
+    }
+    if (axis < 0 || axis > 2 || layer < 0 || layer >= n || quarterTurns == 0) {
+        return;
+    }
+
+    const Rotations &table = rotations();
+    int rotation = 0;
+    for (int i = 0; i < quarterTurns; ++i) {
+        rotation = table.compose[table.quarter[axis]][rotation];
+    }
+
+    // +90 degrees takes (b, c) to (N - 1 - c, b)
+    const int b = (axis + 1) % 3;
+    const int c = (axis + 2) % 3;
+    scratch.clear();
+    forEachInLayer(axis, layer, [&](int x, int y, int z) {
+        int p[3] = { x, y, z };
+        // Stickers on the turned side only move around it; the four sides
+        // around the layer trade theirs
+        countStickers(slotCubie[slotOf(x, y, z)], p, axis, -1);
+        for (int i = 0; i < quarterTurns; ++i) {
+            int nb = n - 1 - p[c];
+            p[c] = p[b];
+            p[b] = nb;
+        }
+        scratch.push_back({ slotCubie[slotOf(x, y, z)], uint16_t(slotOf(p[0], p[1], p[2])) });
+    });
+    for (const std::array<uint16_t, 2> &entry : scratch) {
+        slotCubie[entry[1]] = entry[0];
+        orientations[entry[0]] = table.compose[rotation][orientations[entry[0]]];
+        int p[3] = { homes[entry[1]][0], homes[entry[1]][1], homes[entry[1]][2] };
+        countStickers(entry[0], p, axis, 1);
+        if (moved) {
+            moved->push_back(entry[0]);
+        }
+    }
+    updateUniform(2 * b);
+    updateUniform(2 * b + 1);
+    updateUniform(2 * c);
+    updateUniform(2 * c + 1);
+}
+
+void LayerCube::countStickers(int cubie, const int position[3], int turnAxis, int sign)
+{
+    // The sticker facing outward, side * e_axis, is the one the cubie had
+    // on home side side * (row axis of its rotation)
+    const int8_t (&matrix)[3][3] = rotations().matrix[orientations[cubie]];
+    for (int axis = 0; axis < 3; ++axis) {
+        if (axis == turnAxis || (position[axis] != 0 && position[axis] != n - 1)) {
+            continue;
+        }
+        for (int positive = 0; positive < 2; ++positive) {
+            if (position[axis] != (positive ? n - 1 : 0)) {
+                continue;
+            }
+            for (int i = 0; i < 3; ++i) {
+                if (matrix[axis][i]) {
+                    sideColors[2 * axis + positive][2 * i + ((matrix[axis][i] > 0) == (positive == 1))] += sign;
+                }
+            }
+        }
+    }
+}
+
+void LayerCube::updateUniform(int side)
+{
+    bool single = std::find(sideColors[side].begin(), sideColors[side].end(), n * n) != sideColors[side].end();
+    if (single != uniform[side]) {
+        uniform[side] = single;
+        uniformSides += single ? 1 : -1;
+    }
+}
+
+void LayerCube::layerCubies(int axis, int layer, std::vector<int> &cubies) const
+{
+    cubies.clear();
+    if (axis < 0 || axis > 2 || layer < 0 || layer >= n) {
+        return;
+    }
+    forEachInLayer(axis, layer, [&](int x, int y, int z) {
+        cubies.push_back(slotCubie[slotOf(x, y, z)]);
+    });
+}
@@ -0,0 +1,73 @@
+#ifndef LAYERCUBE_H
+#define LAYERCUBE_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// GL-free N x N x N cube (N from 2 to 20) of the cubies on its surface
+// only: 6N^2 - 12N + 8 of them, never N^3. Each cubie has a slot, its
+// current place in the grid, and an orientation, one of the 24 rotations.
+//
+// Grid coordinates run from 0 to N - 1 along x (left to right), y (down to
+// up) and z (back to front) of the model space the renderer draws in.
+// Cubies are numbered by the slot of their home position, so a new cube
+// has cubieAt(slot) == slot.
+class LayerCube
+{
+public:
+    static constexpr int minSize = 2;
+    static constexpr int maxSize = 20;
+
+    explicit LayerCube(int size = 3);
+
+    int size() const { return n; }
+    int cubieCount() const { return int(slotCubie.size()); }
+    static int surfaceCount(int size) { return size < 2 ? size : 6 * size * size - 12 * size + 8; }
+
+    // Slot of a grid position on the surface, -1 inside the cube
+    int slotOf(int x, int y, int z) const;
+    const std::array<uint8_t, 3> &homePosition(int cubie) const { return homes[cubie]; }
+
+    int cubieAt(int slot) const { return slotCubie[slot]; }
+    int orientation(int cubie) const { return orientations[cubie]; }
+    // Rotation matrix of an orientation, 9 entries row by row
+    static const int8_t *rotationMatrix(int orientation);
+
+    // Turns layer 0..N-1 across axis 0 (x), 1 (y) or 2 (z) by quarterTurns
+    // quarter turns, counterclockwise seen from the positive end of the
+    // axis (the right-handed direction). Writes the cubies it moved to
+    // moved when given.
+    void turnLayer(int axis, int layer, int quarterTurns, std::vector<int> *moved = nullptr);
+
+    // Cubies in a layer, in no particular order
+    void layerCubies(int axis, int layer, std::vector<int> &cubies) const;
+
+    // Every face shows a single color, whatever way the cube is held.
+    // Kept up to date by turnLayer, so this is a single comparison.
+    bool isSolved() const { return uniformSides == 6; }
+
+private:
+    // Calls f(x, y, z) for the surface positions of a layer
+    template <typename F>
+    void forEachInLayer(int axis, int layer, F f) const;
+
+    // Adds sign times the stickers a cubie shows at a grid position on the
+    // sides across the turn axis to sideColors
+    void countStickers(int cubie, const int position[3], int turnAxis, int sign);
+    void updateUniform(int side);
+
+    int n;
+    std::vector<std::array<uint8_t, 3>> homes;
+    std::vector<uint16_t> slotCubie;
+    std::vector<uint8_t> orientations;
+    std::vector<std::array<uint16_t, 2>> scratch;
+
+    // Stickers of each color on each side, sides and colors numbered
+    // 2 * axis + (1 at the positive end), and the sides of one color
+    std::array<std::array<int, 6>, 6> sideColors;
+    std::array<bool, 6> uniform;
+    int uniformSides = 6;
+};
+
+#endif // LAYERCUBE_H
@@ -1,7 +1,13 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include <chrono>
+
 #include <QMessageBox>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "notation.h"
+#include "twophasesolver.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -28,6 +34,19 @@ MainWindow::MainWindow(QWidget *parent)
     timer = new QTimer(this);
     stopwatchTime = new QTime(0, 0);
 
+    tablesWatcher = new QFutureWatcher<void>(this);
+    scrambleWatcher = new QFutureWatcher<std::vector<Move>>(this);
+    solveWatcher = new QFutureWatcher<std::vector<Move>>(this);
+    solveTimer = new QTimer(this);
+    replayTimer = new QTimer(this);
+    ui->replay_box->hide();
+
+    // Map (or on the very first run build) the solver tables in the
+    // background, the window does not wait for them
+    connect(tablesWatcher, SIGNAL(finished()), this, SLOT(tablesLoaded()));
+    tablesWatcher->setFuture(QtConcurrent::run([]() { TwoPhaseSolver::instance(); }));
+    enableControls();
+
     connect(openGLWidget->getRubiksCube(), SIGNAL(cubeSolved()), this, SLOT(cubeSolved()));
     connect(openGLWidget, SIGNAL(firstMove()), this, SLOT(startTimer()));
     connect(timer, SIGNAL(timeout()), this, SLOT(updateTimer()));
@@ -36,12 +55,41 @@ MainWindow::MainWindow(QWidget *parent)
     connect(solCubDialog, SIGNAL(CancelSolution()), this, SLOT(closeDialog()));
 
     connect(ui->history_button, SIGNAL(clicked()), this, SLOT(showHistory()));
+    connect(history, SIGNAL(historyCleared()), this, SLOT(historyCleared()));
+
+    const HistoryLog &log = history->getLog();
+    for (int i = 0; i < log.count(); ++i) {
+        stats.add(log.duration(i));
+    }
+    showStats();
+
+    connect(ui->scramble_button, SIGNAL(clicked()), this, SLOT(scrambleCube()));
+    connect(scrambleWatcher, SIGNAL(finished()), this, SLOT(scrambleFound()));
 
-    connect(ui->scramble_button, SIGNAL(clicked()), openGLWidget, SLOT(updateScramble()));
+    connect(ui->size_spinbox, SIGNAL(valueChanged(int)), this, SLOT(changeCubeSize(int)));
+
+    connect(ui->solve_button, SIGNAL(clicked()), this, SLOT(solveCube()));
+    connect(solveWatcher, SIGNAL(finished()), this, SLOT(solutionFound()));
+    connect(solveTimer, SIGNAL(timeout()), this, SLOT(playSolutionMove()));
+
+    connect(history, SIGNAL(replayRequested(int)), this, SLOT(startReplay(int)));
+    connect(replayTimer, SIGNAL(timeout()), this, SLOT(playReplayStep()));
+    connect(ui->replay_play, SIGNAL(clicked()), this, SLOT(toggleReplay()));
+    connect(ui->replay_forward, SIGNAL(clicked()), this, SLOT(playReplayStep()));
+    connect(ui->replay_back, SIGNAL(clicked()), this, SLOT(stepReplayBack()));
+    connect(ui->replay_slider, SIGNAL(valueChanged(int)), this, SLOT(seekReplay(int)));
+    connect(ui->replay_speed, SIGNAL(valueChanged(double)), this, SLOT(changeReplaySpeed(double)));
+    connect(ui->replay_close, SIGNAL(clicked()), this, SLOT(closeReplay()));
 }
 
 MainWindow::~MainWindow()
 {
+    // The search reports to this window, it must be over first. Neither it
+    // nor a scramble starts before the solver tables are ready, so both
+    // end within moments.
+    solveStopped = true;
+    solveWatcher->waitForFinished();
+    scrambleWatcher->waitForFinished();
     delete ui;
     delete openGLWidget;
     delete solCubDialog;
@@ -51,8 +99,17 @@ MainWindow::~MainWindow()
 
 void MainWindow::cubeSolved()
 {
+    if (autoSolving) {
+        // Solved by the computer: nothing to congratulate or to save
+        timer->stop();
+        stopwatchTime->setHMS(0, 0, 0);
+        ui->timer_label->setText(stopwatchTime->toString("mm:ss"));
+        openGLWidget->setFirstMoveFlag(false);
+        return;
+    }
+
     timer->stop();
-    stopTime = stopwatchTime->toString("mm:ss");
+    stopTime = stopwatchTime->msecsSinceStartOfDay();
 
     openGLWidget->setFirstMoveFlag(false);
 
@@ -90,7 +147,343 @@ void MainWindow::saveSolutionToHistory()
     stopwatchTime->setHMS(0, 0, 0);
     ui->timer_label->setText(stopwatchTime->toString("mm:ss"));
     solCubDialog->close();
-    history->addInfoToFile(stopTime, openGLWidget->getRubiksCube()->getScramble(), openGLWidget->getRubiksCube()->getSolution());
+    RubiksCube *cube = openGLWidget->getRubiksCube();
+    QString solution = cube->getSolution();
+    // Turns that undo each other or add up are saved as one, 3x3x3 only
+    // since the layer prefixes of bigger cubes mean other moves
+    std::vector<Move> moves;
+    if (cube->getSize() == 3 && parseMoves(solution.toStdString(), moves)) {
+        simplifyMoves(moves);
+        solution = QString::fromStdString(formatMoves(moves));
+    }
+    history->addSolve(stopTime, cube->getSize(), cube->getScramble(), solution);
+    stats.add(stopTime);
+    sessionStats.add(stopTime);
+    showStats();
     openGLWidget->getRubiksCube()->getScramble().clear();
     openGLWidget->getRubiksCube()->getSolution().clear();
 }
+
+void MainWindow::historyCleared()
+{
+    stats.clear();
+    sessionStats.clear();
+    showStats();
+}
+
+void MainWindow::showStats()
+{
+    auto format = [](double milliseconds) {
+        if (milliseconds < 0.0) {
+            return QString("-");
+        }
+        int tenths = qRound(milliseconds / 100.0);
+        return QString("%1:%2.%3").arg(tenths / 600).arg(tenths / 10 % 60, 2, 10, QChar('0')).arg(tenths % 10);
+    };
+
+    QStringList lines;
+    for (int i = 0; i < SolveStats::averageCount; ++i) {
+        // Only the averages there have been enough solves for
+        if (stats.count() >= SolveStats::averageSizes[i] || i == 0) {
+            lines << QString("ao%1: %2 (best %3)")
+                         .arg(SolveStats::averageSizes[i])
+                         .arg(format(stats.average(i)))
+                         .arg(format(stats.bestAverage(i)));
+        }
+    }
+    lines << QString("best: %1").arg(format(double(stats.best())));
+    lines << QString("session mean: %1 (%2)").arg(format(sessionStats.mean())).arg(sessionStats.count());
+    ui->stats_label->setText(lines.join('\n'));
+}
+
+void MainWindow::changeCubeSize(int size)
+{
+    // A solve in progress is abandoned with its cube
+    timer->stop();
+    stopwatchTime->setHMS(0, 0, 0);
+    ui->timer_label->setText(stopwatchTime->toString("mm:ss"));
+
+    openGLWidget->setCubeSize(size);
+    enableControls();
+    openGLWidget->setFocus();
+}
+
+void MainWindow::enableControls()
+{
+    // The solver only knows the 3x3x3
+    const bool needsTables = ui->size_spinbox->value() == 3;
+    openGLWidget->setEnabled(true);
+    ui->scramble_button->setEnabled(tablesReady || !needsTables);
+    ui->solve_button->setEnabled(tablesReady && needsTables);
+    ui->size_spinbox->setEnabled(true);
+}
+
+void MainWindow::tablesLoaded()
+{
+    tablesReady = true;
+    statusBar()->clearMessage();
+    if (!autoSolving && !replaying && !scrambleWatcher->isRunning()) {
+        enableControls();
+    }
+}
+
+bool MainWindow::repairTablesIfDamaged()
+{
+    // Searches on damaged tables stop at once, but the tables are only
+    // replaced once none runs any more
+    if (!tablesReady || !TwoPhaseSolver::instance().tablesDamaged()
+            || solveWatcher->isRunning() || scrambleWatcher->isRunning()) {
+        return false;
+    }
+    tablesReady = false;
+    statusBar()->showMessage("The solver tables are damaged, building them again");
+    tablesWatcher->setFuture(QtConcurrent::run([]() { TwoPhaseSolver::repairTables(); }));
+    return true;
+}
+
+void MainWindow::scrambleCube()
+{
+    RubiksCube *cube = openGLWidget->getRubiksCube();
+    if (cube->getSize() != 3) {
+        openGLWidget->updateScramble();
+        return;
+    }
+    if (!tablesReady || scrambleWatcher->isRunning()) {
+        return;
+    }
+    if (repairTablesIfDamaged()) {
+        enableControls();
+        return;
+    }
+    ui->scramble_button->setEnabled(false);
+    ui->solve_button->setEnabled(false);
+    ui->size_spinbox->setEnabled(false);
+
+    RandomScrambler scrambler = cube->newScrambler();
+    scrambleWatcher->setFuture(QtConcurrent::run([scrambler]() mutable { return scrambler.scramble(); }));
+}
+
+void MainWindow::scrambleFound()
+{
+    // A scramble from damaged tables may not be a random state at all
+    if (!repairTablesIfDamaged()) {
+        openGLWidget->getRubiksCube()->scramble(scrambleWatcher->result());
+    }
+    enableControls();
+    openGLWidget->setFocus();
+}
+
+void MainWindow::solveCube()
+{
+    if (solveWatcher->isRunning()) {
+        // Stop: the search returns the shortest solution it has
+        solveStopped = true;
+        ui->solve_button->setEnabled(false);
+        return;
+    }
+    RubiksCube *cube = openGLWidget->getRubiksCube();
+    if (autoSolving || !tablesReady || cube->getSize() != 3 || cube->isSolved()) {
+        return;
+    }
+    if (repairTablesIfDamaged()) {
+        enableControls();
+        return;
+    }
+    autoSolving = true;
+
+    // The cube must not change while the solution is computed and played
+    openGLWidget->setEnabled(false);
+    ui->scramble_button->setEnabled(false);
+    ui->size_spinbox->setEnabled(false);
+    ui->solve_button->setText("Stop");
+
+    // Shorter solutions are looked for until one has 20 moves or a second
+    // is up. The tables are ready before Solve is enabled; were they not,
+    // the second would only start once they are.
+    solveStopped = false;
+    const CubeState state = cube->getState();
+    solveWatcher->setFuture(QtConcurrent::run([this, state]() {
+        const TwoPhaseSolver &solver = TwoPhaseSolver::instance();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        auto improved = [this](const std::vector<Move> &solution) {
+            int length = int(solution.size());
+            QMetaObject::invokeMethod(this, [this, length]() {
+                statusBar()->showMessage(QString("Solution found: %1 moves").arg(length));
+            }, Qt::QueuedConnection);
+        };
+        return solver.solve(state, deadline, improved, &solveStopped, 20);
+    }));
+}
+
+void MainWindow::solutionFound()
+{
+    ui->solve_button->setText("Solve");
+    ui->solve_button->setEnabled(false);
+    if (repairTablesIfDamaged()) {
+        // Whatever was found on them may not solve the cube
+        finishSolve();
+        return;
+    }
+    solutionMoves.clear();
+    for (Move move : solveWatcher->result()) {
+        // Half turns are played as two quarter turns
+        if (move % 3 == 1) {
+            solutionMoves.append(Move(move - 1));
+            solutionMoves.append(Move(move - 1));
+        } else {
+            solutionMoves.append(move);
+        }
+    }
+
+    if (solutionMoves.isEmpty()) {
+        // Stopped, or out of time, before anything was found
+        if (!solveStopped) {
+            statusBar()->showMessage("No solution found in time");
+        }
+        finishSolve();
+        return;
+    }
+    // One tick per turn, so the queued animations follow each other
+    solveTimer->start(openGLWidget->getRubiksCube()->getTurnDuration());
+}
+
+void MainWindow::playSolutionMove()
+{
+    openGLWidget->getRubiksCube()->playMove(solutionMoves.takeFirst());
+    if (solutionMoves.isEmpty()) {
+        finishSolve();
+    }
+}
+
+void MainWindow::finishSolve()
+{
+    solveTimer->stop();
+    autoSolving = false;
+    enableControls();
+    openGLWidget->setFocus();
+}
+
+void MainWindow::startReplay(int logIndex)
+{
+    if (autoSolving || scrambleWatcher->isRunning()) {
+        return;
+    }
+    HistoryLog::Solve solve = history->getLog().solve(logIndex);
+    if (!replay.load(solve.cubeSize, solve.scramble.toStdString(), solve.solution.toStdString())) {
+        QMessageBox::warning(this, "Replay", "The moves of this solve cannot be read.");
+        return;
+    }
+    history->hide();
+
+    timer->stop();
+    stopwatchTime->setHMS(0, 0, 0);
+    ui->timer_label->setText(stopwatchTime->toString("mm:ss"));
+
+    RubiksCube *cube = openGLWidget->getRubiksCube();
+    if (!replaying) {
+        turnsPerSecondBeforeReplay = cube->getTurnsPerSecond();
+    }
+    replaying = true;
+    replayTimer->stop();
+    ui->replay_play->setText("Play");
+
+    // The cube only follows the replay until it is closed
+    openGLWidget->setCubeSize(solve.cubeSize);
+    openGLWidget->setEnabled(false);
+    ui->scramble_button->setEnabled(false);
+    ui->solve_button->setEnabled(false);
+    ui->size_spinbox->setEnabled(false);
+    changeReplaySpeed(ui->replay_speed->value());
+
+    replayPosition = 0;
+    ui->replay_slider->setValue(0);
+    ui->replay_slider->setRange(0, replay.stepCount());
+    showReplayPosition();
+    ui->replay_box->show();
+}
+
+void MainWindow::toggleReplay()
+{
+    if (replayTimer->isActive()) {
+        replayTimer->stop();
+        ui->replay_play->setText("Play");
+        return;
+    }
+    if (replayPosition == replay.stepCount()) {
+        ui->replay_slider->setValue(0);
+    }
+    replayTimer->start();
+    ui->replay_play->setText("Pause");
+}
+
+void MainWindow::playReplayStep()
+{
+    if (replayPosition >= replay.stepCount()) {
+        replayTimer->stop();
+        ui->replay_play->setText("Play");
+        return;
+    }
+    openGLWidget->getRubiksCube()->playStep(replay.step(replayPosition));
+    ++replayPosition;
+    ui->replay_slider->setValue(replayPosition);
+    showReplayPosition();
+}
+
+void MainWindow::stepReplayBack()
+{
+    if (replayPosition == 0) {
+        return;
+    }
+    --replayPosition;
+    openGLWidget->getRubiksCube()->playStep(Replay::inverse(replay.step(replayPosition)));
+    ui->replay_slider->setValue(replayPosition);
+    showReplayPosition();
+}
+
+void MainWindow::seekReplay(int position)
+{
+    // Steps move the slider too, after they have moved the cube
+    if (position == replayPosition) {
+        return;
+    }
+    replayPosition = position;
+    LayerCube state(replay.size());
+    replay.stateAt(position, state);
+    openGLWidget->getRubiksCube()->showState(state);
+    showReplayPosition();
+}
+
+void MainWindow::changeReplaySpeed(double turnsPerSecond)
+{
+    if (!replaying) {
+        return;
+    }
+    RubiksCube *cube = openGLWidget->getRubiksCube();
+    cube->setTurnsPerSecond(turnsPerSecond);
+    replayTimer->setInterval(cube->getTurnDuration());
+}
+
+void MainWindow::showReplayPosition()
+{
+    int scrambleLength = replay.scrambleLength();
+    if (replayPosition <= scrambleLength && scrambleLength > 0) {
+        ui->replay_label->setText(QString("Scramble %1 / %2").arg(replayPosition).arg(scrambleLength));
+    } else {
+        ui->replay_label->setText(QString("Solution %1 / %2")
+                                      .arg(replayPosition - scrambleLength)
+                                      .arg(replay.stepCount() - scrambleLength));
+    }
+}
+
+void MainWindow::closeReplay()
+{
+    replayTimer->stop();
+    replaying = false;
+    ui->replay_box->hide();
+
+    RubiksCube *cube = openGLWidget->getRubiksCube();
+    cube->setTurnsPerSecond(turnsPerSecondBeforeReplay);
+    openGLWidget->setCubeSize(ui->size_spinbox->value());
+    enableControls();
+    openGLWidget->setFocus();
+}
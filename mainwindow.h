@@ -1,6 +1,9 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <atomic>
+
+#include <QFutureWatcher>
 #include <QMainWindow>
 #include <QTimer>
 #include <QTime>
@@ -8,6 +11,7 @@
 #include "openglwidget.h"
 #include "solcubdialog.h"
 #include "history.h"
+#include "solvestats.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -36,13 +40,76 @@ public slots:
 
     void saveSolutionToHistory();
 
+    void changeCubeSize(int size);
+
+    void historyCleared();
+
+    // Replay of a solve from the history
+    void startReplay(int logIndex);
+    void toggleReplay();
+    void playReplayStep();
+    void stepReplayBack();
+    void seekReplay(int position);
+    void changeReplaySpeed(double turnsPerSecond);
+    void closeReplay();
+
+    void tablesLoaded();
+
+    void scrambleCube();
+
+    void scrambleFound();
+
+    void solveCube();
+
+    void solutionFound();
+
+    void playSolutionMove();
+
 private:
+    // Enables what can be used while the cube waits for the user
+    void enableControls();
+    void finishSolve();
+    // Starts building the solver tables again if their check failed
+    bool repairTablesIfDamaged();
+    void showStats();
+    void showReplayPosition();
+
     Ui::MainWindow *ui;
     OpenGLWidget *openGLWidget;
     SolCubDialog *solCubDialog;
     History *history;
     QTimer *timer;
     QTime *stopwatchTime;
-    QString stopTime;
+    // Length of the last solve in ms
+    int stopTime = 0;
+
+    // Over the whole history and since the program started
+    SolveStats stats;
+    SolveStats sessionStats;
+
+    // The 3x3x3 scrambles and solves with the two-phase solver's tables,
+    // which are mapped or built in the background while the window is up
+    QFutureWatcher<void> *tablesWatcher;
+    bool tablesReady = false;
+
+    // A random-state scramble needs a solve, so it is found off the GUI
+    // thread as well
+    QFutureWatcher<std::vector<Move>> *scrambleWatcher;
+
+    // Computer solve: the search runs off the GUI thread until its time is
+    // up or it is stopped, then the moves are played one quarter turn per
+    // tick of solveTimer
+    QFutureWatcher<std::vector<Move>> *solveWatcher;
+    std::atomic<bool> solveStopped { false };
+    QTimer *solveTimer;
+    QVector<Move> solutionMoves;
+    bool autoSolving = false;
+
+    // Scrubbing jumps to a state, playing and stepping animate single turns
+    Replay replay;
+    int replayPosition = 0;
+    QTimer *replayTimer;
+    bool replaying = false;
+    double turnsPerSecondBeforeReplay = 0.0;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,212 @@
+// Micro-benchmark of a single move: CubeState tables against the grid
+// copying that RubiksCube::rotateFace used to do, the state kernel's
+// backends against each other, and CubeBatch.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMatrix4x4>
+#include <QQuaternion>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QVector>
+#include <QVector3D>
+
+#include <vector>
+
+#include "cubebatch.h"
+#include "cubestate.h"
+#include "statekernel.h"
+
+namespace {
+
+// CubeGeometry without the GL handles, copied by value like the old grid
+struct LegacyCubie {
+    float size = 0.25f;
+    QVector<QVector3D> color;
+    QVector3D position;
+    QMatrix4x4 model;
+    QQuaternion rotation;
+    QQuaternion targetRotation;
+    QVector<QVector3D> vertices;
+    QVector<quint16> indices;
+    void *handles[4] = {};
+};
+
+typedef QVector<QVector<QVector<LegacyCubie>>> LegacyGrid;
+
+LegacyGrid makeLegacyGrid()
+{
+    LegacyGrid cubes(3, QVector<QVector<LegacyCubie>>(3, QVector<LegacyCubie>(3)));
+    for (int x = 0; x < 3; ++x) {
+        for (int y = 0; y < 3; ++y) {
+            for (int z = 0; z < 3; ++z) {
+                LegacyCubie &cube = cubes[x][y][z];
+                cube.color = QVector<QVector3D>(6, QVector3D(0.3f, 0.3f, 0.3f));
+                cube.position = QVector3D(x, y, z);
+                cube.vertices = QVector<QVector3D>(48);
+                cube.indices = QVector<quint16>(36);
+            }
+        }
+    }
+    return cubes;
+}
+
+// The body of the old RubiksCube::rotateFace
+void legacyRotateFace(LegacyGrid &cubes, char side, int layer, bool clockwise, bool rotateX, bool rotateY)
+{
+    LegacyGrid tempCubes = cubes;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (rotateX) {
+                if (clockwise == (side == 'R')) {
+                    cubes[layer][j][i] = tempCubes[layer][2-i][j];
+                } else {
+                    cubes[layer][j][i] = tempCubes[layer][i][2-j];
+                }
+            } else if (rotateY) {
+                if (clockwise == (side == 'U')) {
+                    cubes[i][layer][j] = tempCubes[j][layer][2-i];
+                } else {
+                    cubes[i][layer][j] = tempCubes[2-j][layer][i];
+                }
+            } else {
+                if (clockwise == (side == 'F')) {
+                    cubes[i][j][layer] = tempCubes[2-j][i][layer];
+                } else {
+                    cubes[i][j][layer] = tempCubes[j][2-i][layer];
+                }
+            }
+        }
+    }
+}
+
+void legacyTurn(LegacyGrid &cubes, Move move)
+{
+    static const char sides[] = "URFDLB";
+    char side = sides[move / 3];
+    bool clockwise = move % 3 != 2;
+    int turns = move % 3 == 1 ? 2 : 1;
+    for (int n = 0; n < turns; ++n) {
+        switch (side) {
+        case 'U': legacyRotateFace(cubes, side, 2, clockwise, false, true); break;
+        case 'D': legacyRotateFace(cubes, side, 0, clockwise, false, true); break;
+        case 'L': legacyRotateFace(cubes, side, 0, clockwise, true, false); break;
+        case 'R': legacyRotateFace(cubes, side, 2, clockwise, true, false); break;
+        case 'F': legacyRotateFace(cubes, side, 2, clockwise, false, false); break;
+        case 'B': legacyRotateFace(cubes, side, 0, clockwise, false, false); break;
+        }
+    }
+}
+
+QVector<Move> randomMoves(int count, int range)
+{
+    QVector<Move> moves(count);
+    QRandomGenerator generator(2024);
+    for (Move &move : moves) {
+        move = Move(generator.bounded(range));
+    }
+    return moves;
+}
+
+void report(QTextStream &out, const char *name, qint64 nanoseconds, int moves)
+{
+    double perMove = double(nanoseconds) / moves;
+    out << qSetFieldWidth(28) << Qt::left << name << qSetFieldWidth(0)
+        << QString::number(perMove, 'f', 2) << " ns/move  "
+        << QString::number(1000.0 / perMove, 'f', 2) << " M moves/s\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int stateMoves = 20000000;
+    const int legacyMoves = 200000;
+    QVector<Move> faceTurns = randomMoves(1 << 16, faceTurnCount);
+    QVector<Move> allMoves = randomMoves(1 << 16, MoveCount);
+    const int mask = (1 << 16) - 1;
+    QElapsedTimer timer;
+
+    CubeState state;
+    timer.start();
+    for (int i = 0; i < stateMoves; ++i) {
+        state.turn(faceTurns[i & mask]);
+    }
+    report(out, "CubeState::turn", timer.nsecsElapsed(), stateMoves);
+
+    timer.start();
+    for (int i = 0; i < stateMoves; ++i) {
+        state.apply(allMoves[i & mask]);
+    }
+    report(out, "CubeState::apply", timer.nsecsElapsed(), stateMoves);
+
+    // Every backend turns the same cube through the same moves, one call
+    // per move and then whole sequences at once
+    const int sequenceLength = 64;
+    const StateKernel::Backend selected = StateKernel::backend();
+    out << "kernel backends, " << StateKernel::backendName(selected) << " selected\n";
+    for (int backend = 0; backend < StateKernel::BackendCount; ++backend) {
+        QString name = StateKernel::backendName(StateKernel::Backend(backend));
+        if (!StateKernel::isSupported(StateKernel::Backend(backend))) {
+            out << "  " << name << " not supported\n";
+            continue;
+        }
+        StateKernel::setBackend(StateKernel::Backend(backend));
+
+        CubeState single;
+        timer.start();
+        for (int i = 0; i < stateMoves; ++i) {
+            single.turn(faceTurns[i & mask]);
+        }
+        report(out, qPrintable("  " + name + " single"), timer.nsecsElapsed(), stateMoves);
+
+        CubeState sequence;
+        timer.start();
+        for (int i = 0; i < stateMoves; i += sequenceLength) {
+            sequence.turn(faceTurns.constData() + (i & mask), sequenceLength);
+        }
+        report(out, qPrintable("  " + name + " sequence"), timer.nsecsElapsed(), stateMoves);
+
+        if (single != sequence) {
+            out << "  " << name << " sequences disagree with single turns\n";
+        }
+    }
+    StateKernel::setBackend(selected);
+
+    // A batch the size of a training set chunk, all cubes making the same
+    // move and then each its own
+    const int batchCubes = 1 << 16;
+    const int batchMoves = 200;
+    CubeBatch batch(batchCubes);
+    QVector<Move> perCube = randomMoves(batchCubes, faceTurnCount);
+    timer.start();
+    for (int i = 0; i < batchMoves; ++i) {
+        batch.turn(faceTurns[i]);
+    }
+    report(out, "CubeBatch same move", timer.nsecsElapsed(), batchCubes * batchMoves);
+    timer.start();
+    for (int i = 0; i < batchMoves; ++i) {
+        batch.turn(perCube.constData());
+    }
+    report(out, "CubeBatch move per cube", timer.nsecsElapsed(), batchCubes * batchMoves);
+    std::vector<uint8_t> solved(batchCubes);
+    timer.start();
+    for (int i = 0; i < batchMoves; ++i) {
+        batch.solved(solved.data());
+    }
+    report(out, "CubeBatch solved check", timer.nsecsElapsed(), batchCubes * batchMoves);
+
+    LegacyGrid grid = makeLegacyGrid();
+    timer.start();
+    for (int i = 0; i < legacyMoves; ++i) {
+        legacyTurn(grid, faceTurns[i & mask]);
+    }
+    report(out, "legacy rotateFace", timer.nsecsElapsed(), legacyMoves);
+
+    // Keep the results alive
+    out << "checksum " << state.cornerPiece(0) + state.edgePiece(0) + grid[0][0][0].position.x() << "\n";
+    return 0;
+}
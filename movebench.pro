@@ -0,0 +1,14 @@
+# Per-move cost of CubeState against the old grid copying
+# Build it like the application: qmake movebench.pro && make
+
+QT       += core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = movebench
+
+include(cubecore.pri)
+
+SOURCES += \
+    movebench.cpp
@@ -0,0 +1,211 @@
+#ifndef MOVETABLES_H
+#define MOVETABLES_H
+
+#include <cstdint>
+
+// Faces in the order used by the cubie tables (Kociemba's URFDLB)
+enum Face {
+    FaceU, FaceR, FaceF, FaceD, FaceL, FaceB
+};
+
+// Corner slots
+enum Corner {
+    URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB
+};
+
+// Edge slots
+enum Edge {
+    UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR
+};
+
+// All moves understood by CubeState. The first 18 are the face turns in
+// URFDLB order, move = face * 3 + quarterTurns - 1, so they double as
+// indices into MoveTables::faceTurns.
+enum Move : uint8_t {
+    MoveU, MoveU2, MoveUPrime,
+    MoveR, MoveR2, MoveRPrime,
+    MoveF, MoveF2, MoveFPrime,
+    MoveD, MoveD2, MoveDPrime,
+    MoveL, MoveL2, MoveLPrime,
+    MoveB, MoveB2, MoveBPrime,
+
+    MoveM, MoveM2, MoveMPrime,
+    MoveE, MoveE2, MoveEPrime,
+    MoveS, MoveS2, MoveSPrime,
+
+    MoveUw, MoveUw2, MoveUwPrime,
+    MoveRw, MoveRw2, MoveRwPrime,
+    MoveFw, MoveFw2, MoveFwPrime,
+    MoveDw, MoveDw2, MoveDwPrime,
+    MoveLw, MoveLw2, MoveLwPrime,
+    MoveBw, MoveBw2, MoveBwPrime,
+
+    MoveX, MoveX2, MoveXPrime,
+    MoveY, MoveY2, MoveYPrime,
+    MoveZ, MoveZ2, MoveZPrime,
+
+    MoveCount
+};
+
+constexpr int faceTurnCount = 18;
+
+namespace MoveTables {
+
+// Permutation of the cubies in the centers' frame: slot i receives the
+// piece from perm[i], twisted or flipped by the orientation delta
+struct CubieMove {
+    uint8_t cornerPerm[8];
+    uint8_t cornerTwist[8];
+    uint8_t edgePerm[12];
+    uint8_t edgeFlip[12];
+};
+
+// Any move is at most two face turns in the centers' frame followed by a
+// new placement of the centers (newCenters[i] = centers[centerPerm[i]]).
+// Face turns are given for the solved orientation and are remapped through
+// the current centers when applied; noTurn pads moves with fewer turns.
+struct MoveSteps {
+    uint8_t turns[2];
+    uint8_t centerPerm[6];
+};
+
+constexpr uint8_t noTurn = faceTurnCount;
+
+inline constexpr CubieMove quarterTurns[6] = {
+    // U
+    { { UBR, URF, UFL, ULB, DFR, DLF, DBL, DRB }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+      { UB, UR, UF, UL, DR, DF, DL, DB, FR, FL, BL, BR }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } },
+    // R
+    { { DFR, UFL, ULB, URF, DRB, DLF, DBL, UBR }, { 2, 0, 0, 1, 1, 0, 0, 2 },
+      { FR, UF, UL, UB, BR, DF, DL, DB, DR, FL, BL, UR }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } },
+    // F
+    { { UFL, DLF, ULB, UBR, URF, DFR, DBL, DRB }, { 1, 2, 0, 0, 2, 1, 0, 0 },
+      { UR, FL, UL, UB, DR, FR, DL, DB, UF, DF, BL, BR }, { 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0 } },
+    // D
+    { { URF, UFL, ULB, UBR, DLF, DBL, DRB, DFR }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+      { UR, UF, UL, UB, DF, DL, DB, DR, FR, FL, BL, BR }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } },
+    // L
+    { { URF, ULB, DBL, UBR, DFR, UFL, DLF, DRB }, { 0, 1, 2, 0, 0, 2, 1, 0 },
+      { UR, UF, BL, UB, DR, DF, FL, DB, FR, UL, DL, BR }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } },
+    // B
+    { { URF, UFL, UBR, DRB, DFR, DLF, ULB, DBL }, { 0, 0, 1, 2, 0, 0, 2, 1 },
+      { UR, UF, UL, BR, DR, DF, DL, BL, FR, FL, UB, DB }, { 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1 } }
+};
+
+// Whole-cube quarter rotations x, y and z
+inline constexpr uint8_t quarterRotations[3][6] = {
+    { FaceF, FaceR, FaceD, FaceB, FaceL, FaceU },
+    { FaceU, FaceB, FaceR, FaceD, FaceF, FaceL },
+    { FaceL, FaceU, FaceF, FaceR, FaceD, FaceB }
+};
+
+constexpr CubieMove identityMove()
+{
+    CubieMove move = {};
+    for (int i = 0; i < 8; ++i) {
+        move.cornerPerm[i] = i;
+    }
+    for (int i = 0; i < 12; ++i) {
+        move.edgePerm[i] = i;
+    }
+    return move;
+}
+
+// a followed by b
+constexpr CubieMove compose(const CubieMove &a, const CubieMove &b)
+{
+    CubieMove move = {};
+    for (int i = 0; i < 8; ++i) {
+        move.cornerPerm[i] = a.cornerPerm[b.cornerPerm[i]];
+        move.cornerTwist[i] = (a.cornerTwist[b.cornerPerm[i]] + b.cornerTwist[i]) % 3;
+    }
+    for (int i = 0; i < 12; ++i) {
+        move.edgePerm[i] = a.edgePerm[b.edgePerm[i]];
+        move.edgeFlip[i] = a.edgeFlip[b.edgePerm[i]] ^ b.edgeFlip[i];
+    }
+    return move;
+}
+
+struct FaceTurnTable {
+    CubieMove moves[faceTurnCount + 1];
+};
+
+constexpr FaceTurnTable buildFaceTurns()
+{
+    FaceTurnTable table = {};
+    for (int face = 0; face < 6; ++face) {
+        CubieMove move = identityMove();
+        for (int n = 0; n < 3; ++n) {
+            move = compose(move, quarterTurns[face]);
+            table.moves[face * 3 + n] = move;
+        }
+    }
+    table.moves[noTurn] = identityMove();
+    return table;
+}
+
+// The 18 face turns plus the identity at index noTurn
+inline constexpr FaceTurnTable faceTurns = buildFaceTurns();
+
+constexpr uint8_t faceTurn(int face, int quarterTurns)
+{
+    return face * 3 + (quarterTurns + 3) % 4;
+}
+
+constexpr MoveSteps steps(uint8_t first, uint8_t second, int axis, int quarterTurns)
+{
+    MoveSteps move = { { first, second }, { FaceU, FaceR, FaceF, FaceD, FaceL, FaceB } };
+    for (int n = 0; n < (quarterTurns + 4) % 4; ++n) {
+        uint8_t centers[6] = {};
+        for (int i = 0; i < 6; ++i) {
+            centers[i] = move.centerPerm[quarterRotations[axis][i]];
+        }
+        for (int i = 0; i < 6; ++i) {
+            move.centerPerm[i] = centers[i];
+        }
+    }
+    return move;
+}
+
+struct MoveStepTable {
+    MoveSteps moves[MoveCount];
+};
+
+constexpr MoveStepTable buildMoveSteps()
+{
+    MoveStepTable table = {};
+    for (int n = 1; n <= 3; ++n) {
+        int i = n - 1;
+        for (int face = 0; face < 6; ++face) {
+            table.moves[MoveU + face * 3 + i] = steps(faceTurn(face, n), noTurn, 0, 0);
+        }
+
+        // Slices turn both outer layers the other way and rotate the cube
+        table.moves[MoveM + i] = steps(faceTurn(FaceR, n), faceTurn(FaceL, -n), 0, -n);
+        table.moves[MoveE + i] = steps(faceTurn(FaceU, n), faceTurn(FaceD, -n), 1, -n);
+        table.moves[MoveS + i] = steps(faceTurn(FaceF, -n), faceTurn(FaceB, n), 2, n);
+
+        // Wide turns are the opposite face plus a rotation
+        table.moves[MoveUw + i] = steps(faceTurn(FaceD, n), noTurn, 1, n);
+        table.moves[MoveRw + i] = steps(faceTurn(FaceL, n), noTurn, 0, n);
+        table.moves[MoveFw + i] = steps(faceTurn(FaceB, n), noTurn, 2, n);
+        table.moves[MoveDw + i] = steps(faceTurn(FaceU, n), noTurn, 1, -n);
+        table.moves[MoveLw + i] = steps(faceTurn(FaceR, n), noTurn, 0, -n);
+        table.moves[MoveBw + i] = steps(faceTurn(FaceF, n), noTurn, 2, -n);
+
+        table.moves[MoveX + i] = steps(noTurn, noTurn, 0, n);
+        table.moves[MoveY + i] = steps(noTurn, noTurn, 1, n);
+        table.moves[MoveZ + i] = steps(noTurn, noTurn, 2, n);
+    }
+    return table;
+}
+
+inline constexpr MoveStepTable moveSteps = buildMoveSteps();
+
+static_assert(faceTurns.moves[MoveU2].cornerPerm[URF] == ULB, "U2 swaps URF and ULB");
+static_assert(faceTurns.moves[MoveRPrime].cornerPerm[URF] == UBR, "R' brings UBR to URF");
+static_assert(moveSteps.moves[MoveXPrime].centerPerm[FaceU] == FaceB, "x' brings B to U");
+
+} // namespace MoveTables
+
+#endif // MOVETABLES_H
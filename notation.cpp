@@ -0,0 +1,287 @@
+#include "notation.h"
+
+#include <cstring>
+
+namespace {
+
+// Letters of the 18 groups of three moves, in the order of Move
+const char *const moveNames[MoveCount / 3] = {
+    "U", "R", "F", "D", "L", "B",
+    "M", "E", "S",
+    "Uw", "Rw", "Fw", "Dw", "Lw", "Bw",
+    "x", "y", "z"
+};
+const char *const suffixes[3] = { "", "2", "'" };
+
+const int sliceGroup = MoveM / 3;
+const int wideGroup = MoveUw / 3;
+const int rotationGroup = MoveX / 3;
+
+// Place of the axis of U, R and F among M E S and among x y z
+const int axisPlaces[3] = { 1, 0, 2 };
+
+// Every axis has six kinds of move, each turning the three layers across
+// it (the U, R or F layer, the middle one and the opposite one) by a
+// number of quarter turns in the direction of the U, R or F face
+enum Kind { Face, OppositeFace, Slice, Wide, OppositeWide, Rotation, KindCount };
+
+// Axis 0 is U-D, 1 is R-L and 2 is F-B, kinds in the order of Kind
+const Move axisMoves[3][KindCount] = {
+    { MoveU, MoveD, MoveE, MoveUw, MoveDw, MoveY },
+    { MoveR, MoveL, MoveM, MoveRw, MoveLw, MoveX },
+    { MoveF, MoveB, MoveS, MoveFw, MoveBw, MoveZ }
+};
+
+// Quarter turns of each layer for a clockwise move of each kind. M follows
+// L and E follows D, but S follows F.
+int kindLayer(int axis, int kind, int layer)
+{
+    static const int layers[KindCount][3] = {
+        { 1, 0, 0 }, { 0, 0, -1 }, { 0, -1, 0 }, { 1, 1, 0 }, { 0, -1, -1 }, { 1, 1, 1 }
+    };
+    return kind == Slice && axis == 2 ? -layers[kind][layer] : layers[kind][layer];
+}
+
+// What a run of moves around one axis does: the quarter turns of the three
+// layers, each 0..3, packed as top + 4 * middle + 16 * bottom
+int effectOf(int axis, int kind, int quarterTurns)
+{
+    int effect = 0;
+    for (int layer = 2; layer >= 0; --layer) {
+        effect = effect * 4 + ((kindLayer(axis, kind, layer) * quarterTurns) & 3);
+    }
+    return effect;
+}
+
+int addEffects(int a, int b)
+{
+    int sum = 0;
+    for (int shift = 4; shift >= 0; shift -= 2) {
+        sum = sum * 4 + ((((a >> shift) & 3) + ((b >> shift) & 3)) & 3);
+    }
+    return sum;
+}
+
+// Everything the functions below look up, built on first use
+struct Tables {
+    // Group of moves a letter starts, -1 for the other characters
+    int8_t letterGroups[256];
+
+    uint8_t moveAxes[MoveCount];
+    uint8_t moveEffects[MoveCount];
+    uint8_t sums[64][64];
+
+    // Fewest moves for every effect around every axis, face turns
+    // preferred over slices, wide turns and rotations in that order
+    uint8_t shortestLengths[3][64];
+    Move shortest[3][64][KindCount];
+
+    Tables()
+    {
+        std::memset(letterGroups, -1, sizeof(letterGroups));
+        for (int group = 0; group < MoveCount / 3; ++group) {
+            if (group < wideGroup) {
+                letterGroups[uint8_t(moveNames[group][0])] = group;
+            }
+        }
+        // Wide turns as lowercase letters, rotations only that way
+        for (int face = 0; face < 6; ++face) {
+            letterGroups[uint8_t("urfdlb"[face])] = wideGroup + face;
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            letterGroups[uint8_t("xyz"[axis])] = rotationGroup + axis;
+        }
+
+        for (int axis = 0; axis < 3; ++axis) {
+            for (int kind = 0; kind < KindCount; ++kind) {
+                for (int quarterTurns = 1; quarterTurns <= 3; ++quarterTurns) {
+                    int move = axisMoves[axis][kind] + quarterTurns - 1;
+                    moveAxes[move] = axis;
+                    moveEffects[move] = effectOf(axis, kind, quarterTurns);
+                }
+            }
+        }
+        for (int a = 0; a < 64; ++a) {
+            for (int b = 0; b < 64; ++b) {
+                sums[a][b] = addEffects(a, b);
+            }
+        }
+
+        // Tries all 4^6 combinations of the kinds
+        for (int axis = 0; axis < 3; ++axis) {
+            int penalties[64];
+            for (int effect = 0; effect < 64; ++effect) {
+                shortestLengths[axis][effect] = KindCount + 1;
+            }
+            for (int combination = 0; combination < 1 << (2 * KindCount); ++combination) {
+                int effect = 0;
+                int length = 0;
+                int penalty = 0;
+                for (int kind = 0; kind < KindCount; ++kind) {
+                    int quarterTurns = (combination >> (2 * kind)) & 3;
+                    if (quarterTurns) {
+                        effect = addEffects(effect, effectOf(axis, kind, quarterTurns));
+                        ++length;
+                        penalty += kind;
+                    }
+                }
+                if (length < shortestLengths[axis][effect]
+                        || (length == shortestLengths[axis][effect] && penalty < penalties[effect])) {
+                    shortestLengths[axis][effect] = length;
+                    penalties[effect] = penalty;
+                    int count = 0;
+                    for (int kind = 0; kind < KindCount; ++kind) {
+                        int quarterTurns = (combination >> (2 * kind)) & 3;
+                        if (quarterTurns) {
+                            shortest[axis][effect][count++] = Move(axisMoves[axis][kind] + quarterTurns - 1);
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+const Tables &tables()
+{
+    static const Tables instance;
+    return instance;
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',';
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+} // namespace
+
+bool parseMoves(const std::string &text, std::vector<Move> &moves)
+{
+    const Tables &lookup = tables();
+    moves.clear();
+    moves.reserve(text.size() / 2);
+    const char *i = text.data();
+    const char *end = i + text.size();
+    while (i < end) {
+        if (isSpace(*i)) {
+            ++i;
+            continue;
+        }
+
+        // Layer prefix, face turns only
+        int depth = 0;
+        if (*i >= '1' && *i <= '3') {
+            depth = *i++ - '0';
+            if (i == end || lookup.letterGroups[uint8_t(*i)] < 0 || lookup.letterGroups[uint8_t(*i)] >= sliceGroup) {
+                return false;
+            }
+        }
+
+        int group = lookup.letterGroups[uint8_t(*i++)];
+        if (group < 0) {
+            return false;
+        }
+        bool reversed = false;
+        if (group < sliceGroup) {
+            const int face = group;
+            if (i < end && *i == 'w') {
+                ++i;
+                // Rw and 2Rw turn two layers, 3Rw the whole cube
+                if (depth == 1) {
+                    group = face;
+                } else if (depth == 3) {
+                    group = rotationGroup + axisPlaces[face % 3];
+                    reversed = face >= 3;
+                } else {
+                    group = wideGroup + face;
+                }
+            } else if (depth == 2) {
+                // The slice follows L, D or F
+                group = sliceGroup + axisPlaces[face % 3];
+                reversed = face == FaceU || face == FaceR || face == FaceB;
+            } else if (depth == 3) {
+                group = (face + 3) % 6;
+                reversed = true;
+            }
+        }
+
+        // Count and prime in either order: U2', U'2, U3
+        int quarterTurns = 1;
+        bool prime = false;
+        if (i < end && *i == '\'') {
+            prime = true;
+            ++i;
+        }
+        if (i < end && isDigit(*i)) {
+            quarterTurns = 0;
+            while (i < end && isDigit(*i)) {
+                quarterTurns = (quarterTurns * 10 + *i++ - '0') % 4;
+            }
+        }
+        if (!prime && i < end && *i == '\'') {
+            prime = true;
+            ++i;
+        }
+        if (prime != reversed) {
+            quarterTurns = (4 - quarterTurns) % 4;
+        }
+        if (quarterTurns > 0) {
+            moves.push_back(Move(group * 3 + quarterTurns - 1));
+        }
+    }
+    return true;
+}
+
+std::string formatMoves(const std::vector<Move> &moves)
+{
+    // At most three characters and a space for each move
+    std::string text(moves.size() * 4, ' ');
+    char *out = &text[0];
+    for (Move move : moves) {
+        for (const char *c = moveNames[move / 3]; *c; ++c) {
+            *out++ = *c;
+        }
+        if (move % 3) {
+            *out++ = suffixes[move % 3][0];
+        }
+        *out++ = ' ';
+    }
+    text.resize(moves.empty() ? 0 : out - text.data() - 1);
+    return text;
+}
+
+void simplifyMoves(std::vector<Move> &moves)
+{
+    const Tables &lookup = tables();
+
+    // Runs of moves around one axis, merged as they come. A run that cancels out is dropped, so the run before
+    // it can merge with the next move.
+    struct Run {
+        uint8_t axis;
+        uint8_t effect;
+    };
+    std::vector<Run> runs;
+    runs.reserve(moves.size());
+    for (Move move : moves) {
+        uint8_t axis = lookup.moveAxes[move];
+        if (!runs.empty() && runs.back().axis == axis) {
+            runs.back().effect = lookup.sums[runs.back().effect][lookup.moveEffects[move]];
+            if (runs.back().effect == 0) {
+                runs.pop_back();
+            }
+        } else {
+            runs.push_back({ axis, lookup.moveEffects[move] });
+        }
+    }
+
+    moves.clear();
+    for (const Run &run : runs) {
+        const Move *shortest = lookup.shortest[run.axis][run.effect];
+        moves.insert(moves.end(), shortest, shortest + lookup.shortestLengths[run.axis][run.effect]);
+    }
+}
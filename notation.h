@@ -0,0 +1,24 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include <string>
+#include <vector>
+
+#include "cubestate.h"
+
+// Text form of all 54 moves, separated by whitespace, commas or nothing:
+// face turns "U", "U2", "U'" (also "U2'" and "U3"), wide turns "Uw" or
+// "u", slices "M", "E", "S" and rotations "x", "y", "z". A layer prefix
+// counts layers of the 3x3x3 in from a side: "2R" is M', "3R" is L',
+// "3Rw" is x.
+bool parseMoves(const std::string &text, std::vector<Move> &moves);
+std::string formatMoves(const std::vector<Move> &moves);
+
+// Merges neighbouring moves around the same axis and drops the ones that
+// cancel, in place, until no two neighbours share an axis. The result
+// does the same to the cube and to its orientation, with as few moves as
+// possible for every axis and face turns preferred: "U U U U U" is "U",
+// "R Rw'" is "M", "F' F" disappears.
+void simplifyMoves(std::vector<Move> &moves);
+
+#endif // NOTATION_H
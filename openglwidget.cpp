@@ -1,97 +1,69 @@
 #include "openglwidget.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QPainter>
 #include <QtMath>
 
-constexpr float interpolationFactor = 0.05f;
-
 OpenGLWidget::OpenGLWidget(QWidget *parent)
     : QOpenGLWidget(parent)
+    , rubiksCube(new RubiksCube())
+    , scene(rubiksCube)
 {
-    rubiksCube = new RubiksCube();
+    // Frames are only drawn while something moves, see paintGL
+    connect(rubiksCube, SIGNAL(cubesMoved()), this, SLOT(update()));
 
     rotationFrontBackSideAxis = QVector3D(0.0f, 0.0f, 1.0f);
     rotationUpDownSideAxis = QVector3D(0.0f, 1.0f, 0.0f);
     rotationLeftRightSideAxis = QVector3D(1.0f, 0.0f, 0.0f);
-
-    setupCamera();
 }
 
 OpenGLWidget::~OpenGLWidget()
 {
+    makeCurrent();
+    scene.destroy();
+    doneCurrent();
     delete rubiksCube;
 }
 
 void OpenGLWidget::initializeGL()
 {
-    initializeOpenGLFunctions();
-    rubiksCube->setElementsOfCube();
-    glClearColor(0.7f, 1.0f, 0.7f, 1.0f);
-    // glClearColor(0.9529f, 0.9529f, 0.9529f, 1.0f);
+    rubiksCube->setElementsOfCube(rubiksCube->getSize());
+    scene.initialize();
 }
 
 void OpenGLWidget::resizeGL(int w, int h)
 {
-    // Calculate aspect ratio
-    qreal aspect = qreal(w) / qreal(h ? h : 1);
-
-    // Set near plane to 0.1, far plane to 50.0, field of view 45 degrees
-    const qreal zNear = 0.1, zFar = 50.0, fov = 45.0;
-
-    // Reset projection
-    projection.setToIdentity();
-
-    // Set perspective projection
-    projection.perspective(fov, aspect, zNear, zFar);
+    scene.resize(w, h);
 }
 
 void OpenGLWidget::paintGL()
 {
-    // Clear color and depth buffer
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    glEnable(GL_DEPTH_TEST);
-
-    currentOrientation = QQuaternion::slerp(currentOrientation, targetOrientation, interpolationFactor);
-
-    // Calculate view transformation
+    bool animating = scene.render();
 
-    view.setToIdentity();
-    QVector3D front(0.0f, 0.0f, 0.0f);
-    front.setX(cos(qDegreesToRadians(yaw)) * cos(qDegreesToRadians(pitch)));
-    front.setY(sin(qDegreesToRadians(pitch)));
-    front.setZ(sin(qDegreesToRadians(yaw)) * cos(qDegreesToRadians(pitch)));
-    cameraFront = front.normalized();
-
-    view.lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-
-    // Draw cube geometry
-    vec3Cube &cubes = rubiksCube->getCubes();
-    for (int x = 0; x < 3; ++x) {
-        for (int y = 0; y < 3; ++y) {
-            for (int z = 0; z < 3; ++z) {
-                CubeGeometry &cube = cubes[x][y][z];
-                model.setToIdentity();
-                model.rotate(currentOrientation);
-
-                cube.SetRotation(QQuaternion::slerp(cube.GetRotation(), cube.GetTargetRotation(), interpolationFactor * 2));
-                model.rotate(cube.GetRotation());
-
-                model.translate(cube.GetPosition());
-                cube.SetModel(model);
+    if (profilerOverlay) {
+        QPainter painter(this);
+        painter.setPen(Qt::black);
+        painter.setFont(QFont("monospace", 9));
+        painter.drawText(rect().adjusted(8, 8, -8, -8), Qt::AlignLeft | Qt::AlignTop, scene.getProfiler().overlayText());
+    }
 
-                cube.drawCubeGeometry(projection, view);
-            }
-        }
+    // Input, resizes and new turns schedule a frame themselves; keep going
+    // only until every animation has reached its target
+    if (animating) {
+        update();
     }
+}
+
+void OpenGLWidget::setProfilerOverlay(bool visible)
+{
+    profilerOverlay = visible;
     update();
 }
 
-void OpenGLWidget::setupCamera()
+bool OpenGLWidget::saveProfile(const QString &path) const
 {
-    // Camera setup
-    cameraPos = QVector3D(3.0f, 3.0f, 3.0f);
-    cameraFront = QVector3D(-0.525f, -0.525f, 0.525f) - cameraPos;
-    cameraFront.normalize();
-    cameraUp = QVector3D(0.0f, 1.0f, 0.0f);
+    return scene.getProfiler().writeCsv(path);
 }
 
 void OpenGLWidget::mousePressEvent(QMouseEvent *event)
@@ -153,9 +125,8 @@ void OpenGLWidget::mouseMoveEvent(QMouseEvent *event)
             updateRotationSideAxises(rotationAxis, clockwise);
             rubiksCube->rotateAllCubes(rotationAxis, clockwise);
 
-            QQuaternion rotation = QQuaternion::fromAxisAndAngle(rotationAxis, angle);
-
-            targetOrientation = rotation.normalized() * targetOrientation;
+            scene.rotateOrientation(QQuaternion::fromAxisAndAngle(rotationAxis, angle));
+            update();
 
             rightButtonPressed = false;
         }
@@ -206,6 +177,23 @@ void OpenGLWidget::updateRotationSideAxises(QVector3D rotationAroundAxis, bool c
     }
 }
 
+void OpenGLWidget::setCubeSize(int size)
+{
+    // The new cube is seen from the start, like the first one
+    rotationFrontBackSideAxis = QVector3D(0.0f, 0.0f, 1.0f);
+    rotationUpDownSideAxis = QVector3D(0.0f, 1.0f, 0.0f);
+    rotationLeftRightSideAxis = QVector3D(1.0f, 0.0f, 0.0f);
+    rubiksCube->changeRotationAxis(rotationUpDownSideAxis, 0);
+    rubiksCube->changeRotationAxis(rotationFrontBackSideAxis, 1);
+    rubiksCube->changeRotationAxis(rotationLeftRightSideAxis, 2);
+    scene.resetOrientation();
+
+    rubiksCube->setSize(size);
+    layerNumber = 0;
+    firstMoveFlag = false;
+    update();
+}
+
 void OpenGLWidget::updateScramble()
 {
     rubiksCube->scramble();
@@ -218,6 +206,9 @@ void OpenGLWidget::keyPressEvent(QKeyEvent *event)
     QQuaternion rotation;
     bool clockwise = true;
     QVector<CubeGeometry *> cubesOnSide;
+    const int layerDepth = qBound(0, layerNumber - 1, rubiksCube->getSize() - 1);
+    // "2U" for the second layer from the top and so on
+    QString prefix = layerDepth > 0 ? QString::number(layerDepth + 1) : QString();
     switch (event->key()) {
         case Qt::Key_W:
             if (!firstMoveFlag) {
@@ -228,14 +219,15 @@ void OpenGLWidget::keyPressEvent(QKeyEvent *event)
             if (event->modifiers() & Qt::ShiftModifier) {
                 rotation = QQuaternion::fromAxisAndAngle(rotationUpDownSideAxis, 90.0f);
                 clockwise = false;
-                rubiksCube->addToSolution("U' ");
+                rubiksCube->addToSolution(prefix + "U' ");
             } else {
                 rotation = QQuaternion::fromAxisAndAngle(rotationUpDownSideAxis, -90.0f);
                 clockwise = true;
-                rubiksCube->addToSolution("U ");
+                rubiksCube->addToSolution(prefix + "U ");
             }
 
-            rubiksCube->rotateSide(rotation, 'U', clockwise);
+            rubiksCube->rotateLayer(rotation, 'U', layerDepth, clockwise);
+            layerNumber = 0;
             break;
         case Qt::Key_S:
             if (!firstMoveFlag) {
@@ -246,14 +238,15 @@ void OpenGLWidget::keyPressEvent(QKeyEvent *event)
             if (event->modifiers() & Qt::ShiftModifier) {
                 rotation = QQuaternion::fromAxisAndAngle(rotationUpDownSideAxis, -90.0f);
                 clockwise = false;
-                rubiksCube->addToSolution("D' ");
+                rubiksCube->addToSolution(prefix + "D' ");
             } else {
                 rotation = QQuaternion::fromAxisAndAngle(rotationUpDownSideAxis, 90.0f);
                 clockwise = true;
-                rubiksCube->addToSolution("D ");
+                rubiksCube->addToSolution(prefix + "D ");
             }
 
-            rubiksCube->rotateSide(rotation, 'D', clockwise);
+            rubiksCube->rotateLayer(rotation, 'D', layerDepth, clockwise);
+            layerNumber = 0;
             break;
         case Qt::Key_A:
             if (!firstMoveFlag) {
@@ -264,14 +257,15 @@ void OpenGLWidget::keyPressEvent(QKeyEvent *event)
             if (event->modifiers() & Qt::ShiftModifier) {
                 rotation = QQuaternion::fromAxisAndAngle(rotationLeftRightSideAxis, -90.0f);
                 clockwise = false;
-                rubiksCube->addToSolution("L' ");
+                rubiksCube->addToSolution(prefix + "L' ");
             } else {
                 rotation = QQuaternion::fromAxisAndAngle(rotationLeftRightSideAxis, 90.0f);
                 clockwise = true;
-                rubiksCube->addToSolution("L ");
+                rubiksCube->addToSolution(prefix + "L ");
             }
 
-            rubiksCube->rotateSide(rotation, 'L', clockwise);
+            rubiksCube->rotateLayer(rotation, 'L', layerDepth, clockwise);
+            layerNumber = 0;
             break;
         case Qt::Key_D:
             if (!firstMoveFlag) {
@@ -282,14 +276,15 @@ void OpenGLWidget::keyPressEvent(QKeyEvent *event)
             if (event->modifiers() & Qt::ShiftModifier) {
                 rotation = QQuaternion::fromAxisAndAngle(rotationLeftRightSideAxis, 90.0f);
                 clockwise = false;
-                rubiksCube->addToSolution("R' ");
+                rubiksCube->addToSolution(prefix + "R' ");
             } else {
                 rotation = QQuaternion::fromAxisAndAngle(rotationLeftRightSideAxis, -90.0f);
                 clockwise = true;
-                rubiksCube->addToSolution("R ");
+                rubiksCube->addToSolution(prefix + "R ");
             }
 
-            rubiksCube->rotateSide(rotation, 'R', clockwise);
+            rubiksCube->rotateLayer(rotation, 'R', layerDepth, clockwise);
+            layerNumber = 0;
             break;
         case Qt::Key_E:
             if (!firstMoveFlag) {
@@ -300,14 +295,15 @@ void OpenGLWidget::keyPressEvent(QKeyEvent *event)
             if (event->modifiers() & Qt::ShiftModifier) {
                 rotation = QQuaternion::fromAxisAndAngle(rotationFrontBackSideAxis, 90.0f);
                 clockwise = false;
-                rubiksCube->addToSolution("F' ");
+                rubiksCube->addToSolution(prefix + "F' ");
             } else {
                 rotation = QQuaternion::fromAxisAndAngle(rotationFrontBackSideAxis, -90.0f);
                 clockwise = true;
-                rubiksCube->addToSolution("F ");
+                rubiksCube->addToSolution(prefix + "F ");
             }
 
-            rubiksCube->rotateSide(rotation, 'F', clockwise);
+            rubiksCube->rotateLayer(rotation, 'F', layerDepth, clockwise);
+            layerNumber = 0;
             break;
         case Qt::Key_Q:
             if (!firstMoveFlag) {
@@ -318,15 +314,33 @@ void OpenGLWidget::keyPressEvent(QKeyEvent *event)
             if (event->modifiers() & Qt::ShiftModifier) {
                 rotation = QQuaternion::fromAxisAndAngle(rotationFrontBackSideAxis, -90.0f);
                 clockwise = false;
-                rubiksCube->addToSolution("B' ");
+                rubiksCube->addToSolution(prefix + "B' ");
             } else {
                 rotation = QQuaternion::fromAxisAndAngle(rotationFrontBackSideAxis, 90.0f);
                 clockwise = true;
-                rubiksCube->addToSolution("B ");
+                rubiksCube->addToSolution(prefix + "B ");
             }
 
-            rubiksCube->rotateSide(rotation, 'B', clockwise);
+            rubiksCube->rotateLayer(rotation, 'B', layerDepth, clockwise);
+            layerNumber = 0;
+            break;
+        case Qt::Key_0: case Qt::Key_1: case Qt::Key_2:
+        case Qt::Key_3: case Qt::Key_4: case Qt::Key_5:
+        case Qt::Key_6: case Qt::Key_7: case Qt::Key_8: case Qt::Key_9:
+            // Digits add up to a layer number until a face key takes it, so
+            // every layer of the 20x20x20 can be reached
+            layerNumber = qMin(layerNumber * 10 + event->key() - Qt::Key_0, rubiksCube->getSize());
+            break;
+        case Qt::Key_F3:
+            setProfilerOverlay(!profilerOverlay);
             break;
+        case Qt::Key_F4: {
+            QString path = QDir(QCoreApplication::applicationDirPath()).filePath("frames.csv");
+            if (!saveProfile(path)) {
+                qWarning() << "Could not write" << path;
+            }
+            break;
+        }
     }
 }
 
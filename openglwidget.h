@@ -2,21 +2,16 @@
 #define OPENGLWIDGET_H
 
 #include <QOpenGLWidget>
-#include <QOpenGLFunctions>
-#include <QOpenGLShaderProgram>
-#include <QOpenGLShader>
 #include <QOpenGLContext>
-#include <QMatrix4x4>
 #include <QQuaternion>
 #include <QMouseEvent>
 #include <QKeyEvent>
 #include <QObject>
 
+#include "cubescene.h"
 #include "rubikscube.h"
 
-#define vec3Cube QVector<QVector<QVector<CubeGeometry>>> // 3x3x3 cube
-
-class OpenGLWidget : public QOpenGLWidget, protected QOpenGLFunctions
+class OpenGLWidget : public QOpenGLWidget
 {
     Q_OBJECT
 public:
@@ -27,8 +22,16 @@ public:
 
     void setFirstMoveFlag(bool flag) { firstMoveFlag = flag; }
 
+    // F3 toggles the overlay, F4 saves the kept frames as CSV next to the
+    // executable
+    const FrameProfiler &getProfiler() const { return scene.getProfiler(); }
+    void setProfilerOverlay(bool visible);
+    bool saveProfile(const QString &path) const;
+
 public slots:
     void updateScramble();
+    // Replaces the cube with a solved one of size x size x size cubies
+    void setCubeSize(int size);
 
 protected:
     void initializeGL() override;
@@ -43,8 +46,6 @@ protected:
     void mouseMoveEvent(QMouseEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
 
-    void setupCamera();
-
     void updateRotationSideAxises(QVector3D rotationAroundAxis, bool clockwise);
 
 signals:
@@ -52,21 +53,15 @@ signals:
 
 private:
     RubiksCube *rubiksCube;
+    CubeScene scene;
 
-    bool firstMoveFlag = false;
-
-    QVector3D cameraPos;
-    QVector3D cameraFront;
-    QVector3D cameraUp;
+    bool profilerOverlay = false;
 
-    QMatrix4x4 projection;
-    QMatrix4x4 model;
-    QMatrix4x4 view;
+    bool firstMoveFlag = false;
 
-    // float yaw = 270.0f;
-    float yaw = 225.0f;
-    float pitch = -35.0f;
-    // float pitch = 0.0f;
+    // Digits typed before a face key, the layer of the next turn counted
+    // from its side: 1 or nothing for the outer layer, 12 for the twelfth
+    int layerNumber = 0;
 
     QPoint lastMousePos;
     bool rightButtonPressed = false;
@@ -76,8 +71,6 @@ private:
     QVector3D rotationLeftRightSideAxis;
     QVector3D rotationFrontBackSideAxis;
 
-    QQuaternion targetOrientation;
-    QQuaternion currentOrientation;
     QQuaternion targetRotation;
     QQuaternion currentRotation;
 };
@@ -0,0 +1,129 @@
+// Solves random scrambles optimally and prints how fast every worker
+// searched, to see how the root splitting scales across cores.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "optimalsolver.h"
+#include "patterndatabase.h"
+
+namespace {
+
+QString moveText(const std::vector<Move> &moves)
+{
+    static const char faces[] = "URFDLB";
+    static const char *suffixes[] = { "", "2", "'" };
+    QStringList text;
+    for (Move move : moves) {
+        text << QString(faces[move / 3]) + suffixes[move % 3];
+    }
+    return text.join(' ');
+}
+
+std::vector<Move> randomScramble(QRandomGenerator &generator, int length)
+{
+    std::vector<Move> moves;
+    int lastFace = -1;
+    while (int(moves.size()) < length) {
+        int move = generator.bounded(faceTurnCount);
+        if (move / 3 == lastFace) {
+            continue;
+        }
+        lastFace = move / 3;
+        moves.push_back(Move(move));
+    }
+    return moves;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Optimal solves of random scrambles");
+    parser.addHelpOption();
+    QCommandLineOption lengthOption("length", "Scramble length.", "moves", "17");
+    QCommandLineOption countOption("count", "Number of scrambles.", "count", "3");
+    QCommandLineOption threadsOption("threads", "Worker threads, 0 for one per core.", "threads", "0");
+    QCommandLineOption limitOption("limit", "Cancel a solve after this many seconds, 0 for never.", "seconds", "0");
+    QCommandLineOption seedOption("seed", "Random seed.", "seed", "2024");
+    parser.addOptions({ lengthOption, countOption, threadsOption, limitOption, seedOption });
+    parser.process(app);
+
+    QElapsedTimer timer;
+    timer.start();
+    PatternDatabases::instance();
+    out << "pattern databases ready in " << timer.elapsed() << " ms\n" << Qt::flush;
+
+    OptimalSolver solver(parser.value(threadsOption).toInt());
+    QRandomGenerator generator(parser.value(seedOption).toUInt());
+    const int limit = parser.value(limitOption).toInt();
+
+    for (int i = 0; i < parser.value(countOption).toInt(); ++i) {
+        std::vector<Move> scramble = randomScramble(generator, parser.value(lengthOption).toInt());
+        CubeState state;
+        for (Move move : scramble) {
+            state.turn(move);
+        }
+        out << "scramble " << moveText(scramble) << "\n" << Qt::flush;
+
+        // Cancels the solve from another thread once the limit is over
+        std::atomic<bool> cancelled { false };
+        std::mutex mutex;
+        std::condition_variable solved;
+        bool done = false;
+        std::thread watchdog([&]() {
+            if (limit <= 0) {
+                return;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!solved.wait_for(lock, std::chrono::seconds(limit), [&]() { return done; })) {
+                cancelled = true;
+            }
+        });
+
+        timer.start();
+        std::vector<Move> solution = solver.solve(state, [&](int depth, const std::vector<OptimalSolver::ThreadStats> &) {
+            out << "  depth " << depth << " searched after " << timer.elapsed() << " ms\n" << Qt::flush;
+        }, &cancelled);
+        qint64 elapsed = timer.elapsed();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        solved.notify_all();
+        watchdog.join();
+
+        if (!solution.empty() || state.isSolved()) {
+            out << "  solution " << moveText(solution) << " (" << solution.size() << " moves, "
+                << elapsed << " ms)\n";
+        } else if (cancelled) {
+            out << "  cancelled after " << elapsed << " ms\n";
+        } else {
+            // The file is removed on exit, the next run builds it again
+            out << "  the pattern databases are damaged, run again to rebuild them\n";
+            return 1;
+        }
+
+        double total = 0.0;
+        const std::vector<OptimalSolver::ThreadStats> &stats = solver.threadStats();
+        for (size_t thread = 0; thread < stats.size(); ++thread) {
+            out << "  thread " << thread << ": " << stats[thread].nodes << " nodes, "
+                << QString::number(stats[thread].nodesPerSecond() / 1e6, 'f', 2) << " M nodes/s\n";
+            total += stats[thread].nodesPerSecond();
+        }
+        out << "  all threads: " << QString::number(total / 1e6, 'f', 2) << " M nodes/s\n" << Qt::flush;
+    }
+    return 0;
+}
@@ -0,0 +1,14 @@
+# Optimal solves of random scrambles with per-thread node rates
+# Build it like the application: qmake optimalsolve.pro && make
+
+QT       += core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = optimalsolve
+
+include(cubecore.pri)
+
+SOURCES += \
+    optimalsolve.cpp
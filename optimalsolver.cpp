@@ -0,0 +1,201 @@
+#include "optimalsolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include "cubiecube.h"
+#include "patterndatabase.h"
+
+namespace {
+
+bool sameAxisBlocked(int face, int lastFace)
+{
+    // No two turns of the same face in a row, opposite faces only in URF order
+    return face == lastFace || face == lastFace - 3;
+}
+
+} // namespace
+
+// Depth-first search below a bound, shared by all workers of an iteration
+class OptimalSearch
+{
+public:
+    struct Node {
+        int cornerPerm;
+        int twist;
+        uint8_t edges[12];   // slot * 2 + flip of every piece
+    };
+
+    OptimalSearch(const PatternDatabases &tables, const std::atomic<bool> &cancelled, const std::atomic<bool> &found)
+        : tables(tables)
+        , cancelled(cancelled)
+        , found(found)
+    {}
+
+    Node root(const CubeState &state) const;
+    Node apply(const Node &node, int move) const;
+    int estimate(const Node &node) const;
+    // estimate(node) >= bound, reading as few tables as possible
+    bool reaches(const Node &node, int bound) const;
+
+    // True when path[depth..depth + togo) solves node
+    bool search(const Node &node, int depth, int togo, Move *path, uint64_t &nodes) const;
+
+private:
+    const PatternDatabases &tables;
+    const std::atomic<bool> &cancelled;
+    const std::atomic<bool> &found;
+};
+
+OptimalSearch::Node OptimalSearch::root(const CubeState &state) const
+{
+    CubieCube cube(state);
+    Node node;
+    node.cornerPerm = cube.cornerPerm();
+    node.twist = cube.twist();
+    for (int slot = 0; slot < 12; ++slot) {
+        node.edges[cube.ep[slot]] = slot * 2 + cube.eo[slot];
+    }
+    return node;
+}
+
+OptimalSearch::Node OptimalSearch::apply(const Node &node, int move) const
+{
+    Node next;
+    next.cornerPerm = tables.cornerPermMove[node.cornerPerm * faceTurnCount + move];
+    next.twist = tables.twistMove[node.twist * faceTurnCount + move];
+    for (int i = 0; i < 12; ++i) {
+        next.edges[i] = tables.edgeMove[node.edges[i]][move];
+    }
+    return next;
+}
+
+int OptimalSearch::estimate(const Node &node) const
+{
+    return std::max({ tables.cornerDistance(node.cornerPerm, node.twist),
+                      tables.edgeDistance(0, node.edges),
+                      tables.edgeDistance(1, node.edges) });
+}
+
+bool OptimalSearch::reaches(const Node &node, int bound) const
+{
+    return tables.cornerDistance(node.cornerPerm, node.twist) >= bound
+        || tables.edgeDistance(0, node.edges) >= bound
+        || tables.edgeDistance(1, node.edges) >= bound;
+}
+
+bool OptimalSearch::search(const Node &node, int depth, int togo, Move *path, uint64_t &nodes) const
+{
+    ++nodes;
+    if (togo == 0) {
+        // Only the solved cube has a zero estimate
+        return true;
+    }
+    if (cancelled.load(std::memory_order_relaxed) || found.load(std::memory_order_relaxed)
+            || tables.tablesDamaged()) {
+        return false;
+    }
+
+    int lastFace = depth > 0 ? path[depth - 1] / 3 : -1;
+    for (int move = 0; move < faceTurnCount; ++move) {
+        if (sameAxisBlocked(move / 3, lastFace)) {
+            continue;
+        }
+        Node next = apply(node, move);
+        if (reaches(next, togo)) {
+            continue;
+        }
+        path[depth] = Move(move);
+        if (search(next, depth + 1, togo - 1, path, nodes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+OptimalSolver::OptimalSolver(int threadCount)
+    : pool(threadCount)
+{}
+
+std::vector<Move> OptimalSolver::solve(const CubeState &state, const Progress &progress,
+                                       const std::atomic<bool> *cancel)
+{
+    stats.assign(pool.threadCount(), ThreadStats());
+    if (state.isSolved()) {
+        return {};
+    }
+    const PatternDatabases *tables = PatternDatabases::instance(cancel);
+    if (!tables) {
+        return {};
+    }
+
+    static const std::atomic<bool> never { false };
+    const std::atomic<bool> &cancelled = cancel ? *cancel : never;
+    std::atomic<bool> found { false };
+    std::mutex solutionMutex;
+    std::vector<Move> solution;
+    OptimalSearch search(*tables, cancelled, found);
+    const OptimalSearch::Node root = search.root(state);
+
+    struct Subtree {
+        OptimalSearch::Node node;
+        Move moves[2];
+    };
+
+    for (int depth = search.estimate(root); ; ++depth) {
+        // Every subtree after the first one or two moves that can still
+        // reach the bound becomes a task
+        const int split = std::min(2, depth);
+        std::vector<Subtree> subtrees;
+        std::function<void(const Subtree &, int)> collect = [&](const Subtree &subtree, int length) {
+            if (length == split) {
+                subtrees.push_back(subtree);
+                return;
+            }
+            int lastFace = length > 0 ? subtree.moves[length - 1] / 3 : -1;
+            for (int move = 0; move < faceTurnCount; ++move) {
+                if (sameAxisBlocked(move / 3, lastFace)) {
+                    continue;
+                }
+                Subtree next = subtree;
+                next.node = search.apply(subtree.node, move);
+                next.moves[length] = Move(move);
+                if (search.estimate(next.node) <= depth - length - 1) {
+                    collect(next, length + 1);
+                }
+            }
+        };
+        collect(Subtree { root, {} }, 0);
+
+        std::vector<WorkStealingPool::Task> tasks;
+        for (const Subtree &subtree : subtrees) {
+            tasks.push_back([&, subtree, depth, split](int worker) {
+                auto start = std::chrono::steady_clock::now();
+                Move path[32];
+                std::copy(subtree.moves, subtree.moves + split, path);
+                uint64_t nodes = 0;
+                if (search.search(subtree.node, split, depth - split, path, nodes)) {
+                    std::lock_guard<std::mutex> lock(solutionMutex);
+                    if (!found) {
+                        solution.assign(path, path + depth);
+                        found = true;
+                    }
+                }
+                stats[worker].nodes += nodes;
+                stats[worker].seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            });
+        }
+        pool.run(std::move(tasks));
+
+        if (progress) {
+            progress(depth, stats);
+        }
+        if (cancelled || tables->tablesDamaged()) {
+            return {};
+        }
+        if (found) {
+            return solution;
+        }
+    }
+}
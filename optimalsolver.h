@@ -0,0 +1,50 @@
+#ifndef OPTIMALSOLVER_H
+#define OPTIMALSOLVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "cubestate.h"
+#include "workstealingpool.h"
+
+// Korf's optimal solver: IDA* with the corner and edge pattern databases
+// as heuristic. Every iteration splits the tree after its first two moves
+// and hands the subtrees to a work-stealing pool.
+class OptimalSolver
+{
+public:
+    struct ThreadStats {
+        uint64_t nodes = 0;
+        double seconds = 0.0;   // time spent inside subtrees
+
+        double nodesPerSecond() const { return seconds > 0.0 ? nodes / seconds : 0.0; }
+    };
+
+    // Called after every finished IDA* iteration with its depth
+    typedef std::function<void(int, const std::vector<ThreadStats> &)> Progress;
+
+    // 0 threads means one per core
+    explicit OptimalSolver(int threadCount = 0);
+
+    // Shortest sequence of face turns in the centers' frame that solves the
+    // state. Blocks until done; returns an empty vector once *cancel is set,
+    // from any thread and at any time, also while the first solve loads or
+    // builds the pattern databases. Each solve takes its own flag, so one
+    // set late never reaches the next. Also empty once the databases turn
+    // out to be damaged.
+    std::vector<Move> solve(const CubeState &state, const Progress &progress = Progress(),
+                            const std::atomic<bool> *cancel = nullptr);
+
+    int threadCount() const { return pool.threadCount(); }
+
+    // Per worker totals of the last solve()
+    const std::vector<ThreadStats> &threadStats() const { return stats; }
+
+private:
+    WorkStealingPool pool;
+    std::vector<ThreadStats> stats;
+};
+
+#endif // OPTIMALSOLVER_H
@@ -0,0 +1,360 @@
+#include "patterndatabase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#include "cubiecube.h"
+#include "workstealingpool.h"
+
+const char PatternDatabases::tableFileName[] = "patterns.tables";
+
+namespace {
+
+// Bump whenever the layout of any table changes
+constexpr quint32 tableVersion = 1;
+
+constexpr int unknown = 0x0f;
+
+int nibble(const SolverTable<uint8_t> &table, int index)
+{
+    return (table[index >> 1] >> ((index & 1) * 4)) & 0x0f;
+}
+
+// Nibble table shared by the breadth-first search workers. An entry is
+// claimed with a compare-and-swap on the 32-bit word that holds it, so
+// workers never lock and never overwrite each other's entries.
+class AtomicNibbles
+{
+public:
+    explicit AtomicNibbles(int size)
+        : words((size + 7) / 8)
+    {
+        for (std::atomic<uint32_t> &word : words) {
+            word.store(0xffffffff, std::memory_order_relaxed);
+        }
+    }
+
+    int get(int index) const
+    {
+        return (words[index >> 3].load(std::memory_order_relaxed) >> ((index & 7) * 4)) & 0x0f;
+    }
+
+    bool allUnknown(int index) const
+    {
+        return words[index >> 3].load(std::memory_order_relaxed) == 0xffffffff;
+    }
+
+    // False if the entry was already known
+    bool claim(int index, int value)
+    {
+        std::atomic<uint32_t> &word = words[index >> 3];
+        int shift = (index & 7) * 4;
+        uint32_t old = word.load(std::memory_order_relaxed);
+        uint32_t updated;
+        do {
+            if (((old >> shift) & 0x0f) != unknown) {
+                return false;
+            }
+            updated = (old & ~(0x0fu << shift)) | (uint32_t(value) << shift);
+        } while (!word.compare_exchange_weak(old, updated, std::memory_order_relaxed));
+        return true;
+    }
+
+    // Two entries per byte, the even one in the low nibble
+    void copyTo(SolverTable<uint8_t> &table, int size) const
+    {
+        table.resize((size + 1) / 2);
+        for (size_t i = 0; i < table.size(); ++i) {
+            table[i] = words[i >> 2].load(std::memory_order_relaxed) >> ((i & 3) * 8);
+        }
+    }
+
+private:
+    std::vector<std::atomic<uint32_t>> words;
+};
+
+// Parallel breadth-first search, one level at a time. Every level the
+// entries are split into chunks that run on the pool; neighbours(index,
+// out) writes the 18 indexes one face turn away and must be thread-safe.
+// Returns false, with the table left as it was, once *cancel is set.
+template <typename Neighbours>
+bool buildNibbleTable(SolverTable<uint8_t> &table, int size, int goal, Neighbours neighbours,
+                      WorkStealingPool &pool, int tableIndex, const PatternDatabases::Progress &progress,
+                      const std::atomic<bool> *cancel)
+{
+    const int chunkSize = 1 << 18;
+    AtomicNibbles nibbles(size);
+    nibbles.claim(goal, 0);
+
+    qint64 done = 1;
+    for (int depth = 0; done < size; ++depth) {
+        auto start = std::chrono::steady_clock::now();
+        // Once most entries are known it is cheaper to look from the
+        // unknown ones for a neighbour at the current depth
+        const bool backwards = done > size / 2;
+        std::atomic<qint64> found { 0 };
+
+        std::vector<WorkStealingPool::Task> tasks;
+        for (int first = 0; first < size; first += chunkSize) {
+            int last = std::min(size, first + chunkSize);
+            tasks.push_back([&, first, last, depth, backwards](int) {
+                if (cancel && cancel->load(std::memory_order_relaxed)) {
+                    return;
+                }
+                int out[faceTurnCount];
+                qint64 count = 0;
+                for (int index = first; index < last; ++index) {
+                    if (!backwards && nibbles.allUnknown(index)) {
+                        index |= 7;
+                        continue;
+                    }
+                    if (nibbles.get(index) != (backwards ? unknown : depth)) {
+                        continue;
+                    }
+                    neighbours(index, out);
+                    for (int move = 0; move < faceTurnCount; ++move) {
+                        if (backwards) {
+                            if (nibbles.get(out[move]) == depth) {
+                                count += nibbles.claim(index, depth + 1);
+                                break;
+                            }
+                        } else {
+                            count += nibbles.claim(out[move], depth + 1);
+                        }
+                    }
+                }
+                found += count;
+            });
+        }
+        pool.run(std::move(tasks));
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        done += found;
+        if (progress) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            progress({ tableIndex, depth + 1, found, seconds });
+        }
+    }
+    nibbles.copyTo(table, size);
+    return true;
+}
+
+} // namespace
+
+const PatternDatabases &PatternDatabases::instance()
+{
+    return *instance(nullptr);
+}
+
+const PatternDatabases *PatternDatabases::instance(const std::atomic<bool> *cancel)
+{
+    static std::atomic<const PatternDatabases *> ready { nullptr };
+    static std::timed_mutex mutex;
+    static std::unique_ptr<PatternDatabases> databases;
+
+    if (const PatternDatabases *loaded = ready.load(std::memory_order_acquire)) {
+        return loaded;
+    }
+    // Whoever holds the lock loads or builds the tables, the others look
+    // at cancel now and then while they wait
+    while (!mutex.try_lock_for(std::chrono::milliseconds(50))) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+    }
+    std::lock_guard<std::timed_mutex> lock(mutex, std::adopt_lock);
+    if (!databases) {
+        std::unique_ptr<PatternDatabases> built(new PatternDatabases());
+        if (!built->loadOrBuild(cancel)) {
+            return nullptr;
+        }
+        databases = std::move(built);
+        ready.store(databases.get(), std::memory_order_release);
+    }
+    return databases.get();
+}
+
+bool PatternDatabases::loadOrBuild(const std::atomic<bool> *cancel)
+{
+    initEdgeMoves();
+    if (loadTables()) {
+        return true;
+    }
+    if (cancel && cancel->load(std::memory_order_relaxed)) {
+        return false;
+    }
+    initMoveTables();
+    if (!initTables(0, Progress(), cancel)) {
+        return false;
+    }
+    saveTables();
+    return true;
+}
+
+PatternDatabases::PatternDatabases(int threadCount, const Progress &progress)
+{
+    initEdgeMoves();
+    initMoveTables();
+    initTables(threadCount, progress);
+}
+
+bool PatternDatabases::generate(int threadCount, const Progress &progress)
+{
+    PatternDatabases databases(threadCount, progress);
+    return databases.saveTables();
+}
+
+bool PatternDatabases::loadTables()
+{
+    if (!tableFile.open(TableFile::path(tableFileName), tableVersion)) {
+        return false;
+    }
+    bool mapped = cornerPermMove.map(tableFile, "cornerPermMove", cornerPermCount * faceTurnCount)
+        && twistMove.map(tableFile, "twistMove", twistCount * faceTurnCount)
+        && cornerTable.map(tableFile, "cornerTable", (cornerEntryCount + 1) / 2)
+        && edgeTables[0].map(tableFile, "edgeTable0", (edgeEntryCount + 1) / 2)
+        && edgeTables[1].map(tableFile, "edgeTable1", (edgeEntryCount + 1) / 2);
+    if (!mapped) {
+        tableFile.close();
+    }
+    return mapped;
+}
+
+bool PatternDatabases::saveTables() const
+{
+    return TableFile::write(TableFile::path(tableFileName), tableVersion, {
+        cornerPermMove.describe("cornerPermMove"),
+        twistMove.describe("twistMove"),
+        cornerTable.describe("cornerTable"),
+        edgeTables[0].describe("edgeTable0"),
+        edgeTables[1].describe("edgeTable1")
+    });
+}
+
+void PatternDatabases::initMoveTables()
+{
+    cornerPermMove.resize(cornerPermCount * faceTurnCount);
+    twistMove.resize(twistCount * faceTurnCount);
+
+    CubieCube cube;
+    for (int i = 0; i < cornerPermCount; ++i) {
+        for (int move = 0; move < faceTurnCount; ++move) {
+            cube.setCornerPerm(i);
+            cube.turn(move);
+            cornerPermMove[i * faceTurnCount + move] = cube.cornerPerm();
+        }
+    }
+    for (int i = 0; i < twistCount; ++i) {
+        for (int move = 0; move < faceTurnCount; ++move) {
+            cube.setTwist(i);
+            cube.turn(move);
+            twistMove[i * faceTurnCount + move] = cube.twist();
+        }
+    }
+}
+
+void PatternDatabases::initEdgeMoves()
+{
+    // The piece in slot s moves to the slot that is replaced by s
+    for (int move = 0; move < faceTurnCount; ++move) {
+        const MoveTables::CubieMove &m = MoveTables::faceTurns.moves[move];
+        for (int slot = 0; slot < 12; ++slot) {
+            int from = m.edgePerm[slot];
+            for (int flip = 0; flip < 2; ++flip) {
+                edgeMove[from * 2 + flip][move] = slot * 2 + (flip ^ m.edgeFlip[slot]);
+            }
+        }
+    }
+}
+
+bool PatternDatabases::initTables(int threadCount, const Progress &progress, const std::atomic<bool> *cancel)
+{
+    WorkStealingPool pool(threadCount);
+    bool complete = buildNibbleTable(cornerTable, cornerEntryCount, 0, [this](int index, int *out) {
+        int perm = index / twistCount;
+        int twist = index % twistCount;
+        for (int move = 0; move < faceTurnCount; ++move) {
+            out[move] = cornerPermMove[perm * faceTurnCount + move] * twistCount
+                      + twistMove[twist * faceTurnCount + move];
+        }
+    }, pool, 0, progress, cancel);
+
+    for (int group = 0; complete && group < 2; ++group) {
+        uint8_t goal[edgeGroupSize];
+        for (int i = 0; i < edgeGroupSize; ++i) {
+            goal[i] = (group * edgeGroupSize + i) * 2;
+        }
+        complete = buildNibbleTable(edgeTables[group], edgeEntryCount, edgeIndex(goal), [this](int index, int *out) {
+            uint8_t pieces[edgeGroupSize];
+            uint8_t moved[edgeGroupSize];
+            edgePieces(index, pieces);
+            for (int move = 0; move < faceTurnCount; ++move) {
+                for (int i = 0; i < edgeGroupSize; ++i) {
+                    moved[i] = edgeMove[pieces[i]][move];
+                }
+                out[move] = edgeIndex(moved);
+            }
+        }, pool, 1 + group, progress, cancel);
+    }
+    return complete;
+}
+
+int PatternDatabases::cornerDistance(int perm, int twist) const
+{
+    return nibble(cornerTable, perm * twistCount + twist);
+}
+
+int PatternDatabases::edgeDistance(int group, const uint8_t *edges) const
+{
+    return nibble(edgeTables[group], edgeIndex(edges + group * edgeGroupSize));
+}
+
+int PatternDatabases::edgeIndex(const uint8_t *pieces)
+{
+    // Lehmer rank of the slots among the twelve, then the flips
+    int rank = 0;
+    int flips = 0;
+    for (int i = 0; i < edgeGroupSize; ++i) {
+        int slot = pieces[i] >> 1;
+        int smaller = 0;
+        for (int j = 0; j < i; ++j) {
+            if ((pieces[j] >> 1) < slot) {
+                ++smaller;
+            }
+        }
+        rank = rank * (12 - i) + slot - smaller;
+        flips = flips * 2 + (pieces[i] & 1);
+    }
+    return rank * 64 + flips;
+}
+
+void PatternDatabases::edgePieces(int index, uint8_t *pieces)
+{
+    int flips = index & 63;
+    int rank = index >> 6;
+    int digits[edgeGroupSize];
+    for (int i = edgeGroupSize - 1; i >= 0; --i) {
+        digits[i] = rank % (12 - i);
+        rank /= 12 - i;
+    }
+
+    bool used[12] = {};
+    for (int i = 0; i < edgeGroupSize; ++i) {
+        int skip = digits[i];
+        for (int slot = 0; slot < 12; ++slot) {
+            if (used[slot]) {
+                continue;
+            }
+            if (skip-- == 0) {
+                used[slot] = true;
+                pieces[i] = slot * 2 + ((flips >> (edgeGroupSize - 1 - i)) & 1);
+                break;
+            }
+        }
+    }
+}
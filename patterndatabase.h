@@ -0,0 +1,91 @@
+#ifndef PATTERNDATABASE_H
+#define PATTERNDATABASE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "cubestate.h"
+#include "tablefile.h"
+
+// Pattern databases for the optimal solver: the exact number of moves that
+// solve the corners alone, and each half of the edges alone, at four bits
+// per entry. They are mapped from tableFileName, or built and written there
+// when that file is missing or stale.
+//
+// Corners are indexed by their permutation and twist coordinates. Edges are
+// followed per piece as slot * 2 + flip; a half is six consecutive pieces
+// of the Edge order, UR to DF (0..5) or DL to BR (6..11).
+class PatternDatabases
+{
+public:
+    static const PatternDatabases &instance();
+
+    // The same, but a search for the tables to build gives up once *cancel
+    // is set and returns nullptr; the next call starts it over. Callers
+    // that wait for another one to build them give up as well.
+    static const PatternDatabases *instance(const std::atomic<bool> *cancel);
+
+    static const char tableFileName[];
+
+    // True once the background check of the table file found it damaged;
+    // solves then stop, and the file is removed when the process ends so
+    // that the next one builds it again
+    bool tablesDamaged() const { return tableFile.isDamaged(); }
+
+    // One finished breadth-first search level: table is 0 for the corners
+    // and 1 or 2 for the edge halves, states are the ones found at depth
+    struct Level {
+        int table;
+        int depth;
+        qint64 states;
+        double seconds;
+    };
+    typedef std::function<void(const Level &)> Progress;
+
+    // Builds the tables from scratch with threadCount workers (0 means one
+    // per core) and writes tableFileName
+    static bool generate(int threadCount, const Progress &progress);
+
+    static constexpr int twistCount = 2187;
+    static constexpr int cornerPermCount = 40320;
+    static constexpr int cornerEntryCount = cornerPermCount * twistCount;  // 88179840
+    static constexpr int edgeGroupSize = 6;
+    static constexpr int edgeEntryCount = 665280 * 64;                     // 12!/6! placements, 2^6 flips
+
+    int cornerDistance(int perm, int twist) const;
+    // edges holds slot * 2 + flip of all twelve pieces
+    int edgeDistance(int group, const uint8_t *edges) const;
+
+    // Index of six consecutive pieces and its inverse
+    static int edgeIndex(const uint8_t *pieces);
+    static void edgePieces(int index, uint8_t *pieces);
+
+private:
+    PatternDatabases() = default;
+    PatternDatabases(int threadCount, const Progress &progress);
+
+    friend class OptimalSearch;
+
+    // False if cancelled before the tables were complete
+    bool loadOrBuild(const std::atomic<bool> *cancel);
+    bool loadTables();
+    bool saveTables() const;
+
+    void initEdgeMoves();
+    void initMoveTables();
+    bool initTables(int threadCount, const Progress &progress, const std::atomic<bool> *cancel = nullptr);
+
+    // Move tables, indexed [coordinate * 18 + move]
+    SolverTable<uint16_t> cornerPermMove;
+    SolverTable<uint16_t> twistMove;
+    uint8_t edgeMove[24][faceTurnCount];
+
+    SolverTable<uint8_t> cornerTable;
+    SolverTable<uint8_t> edgeTables[2];
+
+    TableFile tableFile;
+};
+
+#endif // PATTERNDATABASE_H
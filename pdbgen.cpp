@@ -0,0 +1,52 @@
+// Builds the corner and edge pattern databases from scratch with a
+// parallel breadth-first search and prints the rate of every level.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include "patterndatabase.h"
+#include "tablefile.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates the pattern databases");
+    parser.addHelpOption();
+    QCommandLineOption threadsOption("threads", "Worker threads, 0 for one per core.", "threads", "0");
+    QCommandLineOption outputOption("output", "Directory of the RubiksCube binary.", "directory",
+                                    QCoreApplication::applicationDirPath());
+    parser.addOptions({ threadsOption, outputOption });
+    parser.process(app);
+
+    QString directory = parser.value(outputOption);
+    if (!QDir().mkpath(directory)) {
+        out << "cannot create " << directory << "\n";
+        return 1;
+    }
+    TableFile::setDirectory(directory);
+
+    static const char *tableNames[] = { "corners", "edges 1", "edges 2" };
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = PatternDatabases::generate(parser.value(threadsOption).toInt(), [&](const PatternDatabases::Level &level) {
+        double rate = level.seconds > 0.0 ? level.states / level.seconds : 0.0;
+        out << qSetFieldWidth(8) << Qt::left << tableNames[level.table] << qSetFieldWidth(0)
+            << "depth " << qSetFieldWidth(2) << Qt::right << level.depth << qSetFieldWidth(0) << ": "
+            << qSetFieldWidth(10) << level.states << qSetFieldWidth(0) << " states in "
+            << QString::number(level.seconds, 'f', 2) << " s, "
+            << QString::number(rate / 1e6, 'f', 2) << " M states/s\n" << Qt::flush;
+    });
+
+    if (!ok) {
+        out << "could not write " << TableFile::path(PatternDatabases::tableFileName) << "\n";
+        return 1;
+    }
+    out << "wrote " << TableFile::path(PatternDatabases::tableFileName) << " in " << timer.elapsed() << " ms\n";
+    return 0;
+}
@@ -0,0 +1,14 @@
+# Parallel generator of the optimal solver's pattern databases
+# Build it like the application: qmake pdbgen.pro && make
+
+QT       += core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = pdbgen
+
+include(cubecore.pri)
+
+SOURCES += \
+    pdbgen.cpp
@@ -0,0 +1,140 @@
+#include "randomscrambler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "cubiecube.h"
+#include "twophasesolver.h"
+#include "workstealingpool.h"
+
+namespace {
+
+constexpr int minimumLength = 20;
+constexpr size_t scramblesPerTask = 16;
+
+uint64_t splitMix(uint64_t &x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+bool isOdd(const uint8_t *perm, int n)
+{
+    bool odd = false;
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            odd ^= perm[j] < perm[i];
+        }
+    }
+    return odd;
+}
+
+} // namespace
+
+RandomScrambler::RandomScrambler(uint64_t seed, uint64_t stream)
+{
+    this->seed(seed, stream);
+}
+
+void RandomScrambler::seed(uint64_t seed, uint64_t stream)
+{
+    // Nearby seeds and streams still give unrelated states
+    uint64_t x = seed;
+    x = splitMix(x) ^ stream;
+    for (uint64_t &word : s) {
+        word = splitMix(x);
+    }
+}
+
+uint64_t RandomScrambler::next()
+{
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+uint64_t RandomScrambler::random(uint64_t bound)
+{
+    // Values from the incomplete last block would favour the small results
+    const uint64_t limit = std::numeric_limits<uint64_t>::max() - std::numeric_limits<uint64_t>::max() % bound;
+    uint64_t value;
+    do {
+        value = next();
+    } while (value >= limit);
+    return value % bound;
+}
+
+CubeState RandomScrambler::randomState()
+{
+    CubieCube cube;
+    cube.setCornerPerm(int(random(TwoPhaseSolver::cornerPermCount)));
+    cube.setTwist(int(random(TwoPhaseSolver::twistCount)));
+    permutationUnrank(int(random(479001600)), cube.ep, 12);
+    cube.setFlip(int(random(TwoPhaseSolver::flipCount)));
+
+    // Only states whose corner and edge permutations have the same parity
+    // can be reached; swapping two edges pairs the others up one to one
+    if (isOdd(cube.cp, 8) != isOdd(cube.ep, 12)) {
+        std::swap(cube.ep[10], cube.ep[11]);
+    }
+
+    CubeState state;
+    for (int i = 0; i < 8; ++i) {
+        state.setCorner(i, cube.cp[i], cube.co[i]);
+    }
+    for (int i = 0; i < 12; ++i) {
+        state.setEdge(i, cube.ep[i], cube.eo[i]);
+    }
+    return state;
+}
+
+std::vector<Move> RandomScrambler::scramble(int maxLength)
+{
+    const int length = std::max(maxLength, minimumLength);
+    // No deadline, only a solution of at most length moves ends the solve
+    std::vector<Move> moves = TwoPhaseSolver::instance().solve(randomState(), std::chrono::steady_clock::time_point::max(),
+                                                               TwoPhaseSolver::Improved(), nullptr, length);
+
+    // The solution backwards, every quarter turn the other way
+    std::reverse(moves.begin(), moves.end());
+    for (Move &move : moves) {
+        move = Move(move / 3 * 3 + 2 - move % 3);
+    }
+    return moves;
+}
+
+std::vector<Move> RandomScrambler::scrambleAt(uint64_t seed, uint64_t index, int maxLength)
+{
+    return RandomScrambler(seed, index).scramble(maxLength);
+}
+
+void RandomScrambler::generate(uint64_t seed, uint64_t first, std::vector<std::vector<Move>> &scrambles,
+                               WorkStealingPool &pool, int maxLength)
+{
+    std::vector<WorkStealingPool::Task> tasks;
+    for (size_t begin = 0; begin < scrambles.size(); begin += scramblesPerTask) {
+        size_t end = std::min(scrambles.size(), begin + scramblesPerTask);
+        tasks.push_back([&scrambles, seed, first, begin, end, maxLength](int) {
+            RandomScrambler scrambler;
+            for (size_t i = begin; i < end; ++i) {
+                scrambler.seed(seed, first + i);
+                scrambles[i] = scrambler.scramble(maxLength);
+            }
+        });
+    }
+    pool.run(std::move(tasks));
+}
@@ -0,0 +1,55 @@
+#ifndef RANDOMSCRAMBLER_H
+#define RANDOMSCRAMBLER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "cubestate.h"
+
+class WorkStealingPool;
+
+// Random-state scrambles: a state drawn uniformly from all reachable ones,
+// then the two-phase solver's solution of it inverted. Each scrambler owns
+// its generator (xoshiro256**), so threads never share one, and a seed and
+// a stream number always give the same scrambles.
+//
+// Every scramble is a two-phase solve, about 7 ms per core at the default
+// length and 3.5 ms for limits of 26 and up, so a core makes some 10^4
+// scrambles a minute and millions take hours of machine time. Drawing
+// the states alone with randomState() is much faster.
+class RandomScrambler
+{
+public:
+    explicit RandomScrambler(uint64_t seed = 0, uint64_t stream = 0);
+
+    void seed(uint64_t seed, uint64_t stream = 0);
+
+    // Uniform in 0..bound-1
+    uint64_t random(uint64_t bound);
+
+    CubeState randomState();
+
+    // Face turns in the centers' frame that take the solved cube to a new
+    // random state. The solver gets as long as it needs to find one of at
+    // most maxLength moves, so the result does not depend on the machine;
+    // below 20 that can take minutes, so shorter limits count as 20.
+    std::vector<Move> scramble(int maxLength = defaultLength);
+
+    static constexpr int defaultLength = 22;
+
+    // Scramble number index of the series a seed defines: the same whatever
+    // thread or batch it is generated in
+    static std::vector<Move> scrambleAt(uint64_t seed, uint64_t index, int maxLength = defaultLength);
+
+    // Fills scrambles with the scrambles first, first + 1, ... of the series
+    // on all threads of the pool
+    static void generate(uint64_t seed, uint64_t first, std::vector<std::vector<Move>> &scrambles,
+                         WorkStealingPool &pool, int maxLength = defaultLength);
+
+private:
+    uint64_t next();
+
+    uint64_t s[4];
+};
+
+#endif // RANDOMSCRAMBLER_H
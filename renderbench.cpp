@@ -0,0 +1,132 @@
+// Offscreen rendering benchmark: draws the cube through the same CubeScene
+// as OpenGLWidget into a framebuffer object while it plays a fixed sequence
+// of turns, then reports frame rate, draw calls and CPU time per frame.
+// Needs no display or GPU: run it with QT_QPA_PLATFORM=offscreen, and with
+// LIBGL_ALWAYS_SOFTWARE=1 for Mesa's software rasterizer.
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QSurfaceFormat>
+#include <QTextStream>
+
+#include <memory>
+
+#include "cubescene.h"
+#include "notation.h"
+#include "rubikscube.h"
+
+namespace {
+
+// T permutation, its own inverse, so the cube keeps coming back to solved
+const char script[] = "R U R' U' R' F R2 U' R' U' R U R' F'";
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders the cube offscreen and reports the cost of a frame");
+    parser.addHelpOption();
+    QCommandLineOption framesOption("frames", "Frames to render.", "count", "2000");
+    QCommandLineOption widthOption("width", "Framebuffer width.", "pixels", "800");
+    QCommandLineOption heightOption("height", "Framebuffer height.", "pixels", "600");
+    QCommandLineOption speedOption("tps", "Turns per second of the animation.", "turns", "20");
+    QCommandLineOption layersOption("layers", "Cube size, 2 to 20.", "layers", "3");
+    QCommandLineOption csvOption("csv", "Also write the profile of the last frames as CSV.", "file");
+    parser.addOptions({ framesOption, widthOption, heightOption, speedOption, layersOption, csvOption });
+    parser.process(app);
+
+    const int frames = qMax(1, parser.value(framesOption).toInt());
+    const QSize size(parser.value(widthOption).toInt(), parser.value(heightOption).toInt());
+
+    QSurfaceFormat format;
+    format.setDepthBufferSize(24);
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create()) {
+        err << "cannot create an OpenGL 3.3 context\n";
+        return 1;
+    }
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!context.makeCurrent(&surface)) {
+        err << "cannot make the context current\n";
+        return 1;
+    }
+    QOpenGLFunctions *gl = context.functions();
+    err << "renderer: " << reinterpret_cast<const char *>(gl->glGetString(GL_RENDERER)) << "\n" << Qt::flush;
+
+    std::unique_ptr<QOpenGLFramebufferObject> framebuffer(
+        new QOpenGLFramebufferObject(size, QOpenGLFramebufferObject::Depth));
+    framebuffer->bind();
+    gl->glViewport(0, 0, size.width(), size.height());
+
+    RubiksCube cube(parser.value(layersOption).toInt());
+    cube.setTurnsPerSecond(parser.value(speedOption).toDouble());
+
+    CubeScene scene(&cube);
+    scene.initialize();
+    scene.resize(size.width(), size.height());
+
+    std::vector<Move> moves;
+    parseMoves(script, moves);
+
+    // The next turn starts as soon as the previous one has landed
+    size_t next = 0;
+    bool animating = false;
+    qint64 renderNanoseconds = 0;
+    QElapsedTimer total;
+    QElapsedTimer frameTimer;
+    total.start();
+    for (int frame = 0; frame < frames; ++frame) {
+        if (!animating) {
+            cube.playMove(moves[next++ % moves.size()]);
+        }
+        frameTimer.start();
+        animating = scene.render();
+        renderNanoseconds += frameTimer.nsecsElapsed();
+    }
+    gl->glFinish();
+    const double seconds = total.nsecsElapsed() / 1e9;
+
+    const FrameProfiler &profiler = scene.getProfiler();
+    out << "frames            " << frames << " at " << size.width() << "x" << size.height()
+        << ", " << cube.getCubes().size() << " cubies\n"
+        << "turns             " << next << "\n"
+        << "frames/s          " << QString::number(frames / seconds, 'f', 1) << "\n"
+        << "draw calls/frame  " << QString::number(double(scene.getDrawCalls()) / frames, 'f', 2) << "\n"
+        << "cpu ms/frame      " << QString::number(renderNanoseconds / 1e6 / frames, 'f', 3) << " mean, "
+        << QString::number(profiler.percentile(FrameProfiler::Cpu, 0.5), 'f', 3) << " p50, "
+        << QString::number(profiler.percentile(FrameProfiler::Cpu, 0.99), 'f', 3) << " p99\n"
+        << "gpu ms/frame      " << QString::number(profiler.percentile(FrameProfiler::Gpu, 0.5), 'f', 3) << " p50, "
+        << QString::number(profiler.percentile(FrameProfiler::Gpu, 0.99), 'f', 3) << " p99\n";
+    for (int column = FrameProfiler::ViewSetup; column <= FrameProfiler::Submission; ++column) {
+        out << qSetFieldWidth(18) << Qt::left << FrameProfiler::columnNames[column] << qSetFieldWidth(0)
+            << QString::number(profiler.percentile(FrameProfiler::Column(column), 0.5), 'f', 3) << " p50\n";
+    }
+    out.flush();
+
+    int result = 0;
+    if (parser.isSet(csvOption) && !profiler.writeCsv(parser.value(csvOption))) {
+        err << "cannot write " << parser.value(csvOption) << "\n";
+        result = 1;
+    }
+
+    scene.destroy();
+    framebuffer.reset();
+    context.doneCurrent();
+    return result;
+}
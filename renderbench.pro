@@ -0,0 +1,31 @@
+# Offscreen frame cost of the renderer, no display needed
+# Build it like the application: qmake renderbench.pro && make
+
+QT       += core gui opengl
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = renderbench
+
+include(cubecore.pri)
+
+SOURCES += \
+    cubegeometry.cpp \
+    cuberenderer.cpp \
+    cubescene.cpp \
+    frameprofiler.cpp \
+    renderbench.cpp \
+    rubikscube.cpp
+
+HEADERS += \
+    cubegeometry.h \
+    cuberenderer.h \
+    cubescene.h \
+    frameprofiler.h \
+    rubikscube.h
+
+RESOURCES += \
+    shaders.qrc
+
+win32: LIBS += -lopengl32
@@ -0,0 +1,161 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "notation.h"
+
+namespace {
+
+// Axis of each face in LayerCube coordinates, and whether the face is at
+// its positive end, in the order of Face
+const int faceAxes[6] = { 1, 0, 2, 1, 0, 2 };
+const bool facePositive[6] = { true, true, true, false, false, false };
+
+// Layers of the 3x3x3 for the 18 groups of Move, and the right-handed
+// quarter turns of their clockwise move
+const Replay::Step moveSteps[MoveCount / 3] = {
+    { 1, 2, 2, -1 }, { 0, 2, 2, -1 }, { 2, 2, 2, -1 },      // U R F
+    { 1, 0, 0, 1 }, { 0, 0, 0, 1 }, { 2, 0, 0, 1 },         // D L B
+    { 0, 1, 1, 1 }, { 1, 1, 1, 1 }, { 2, 1, 1, -1 },        // M like L, E like D, S like F
+    { 1, 1, 2, -1 }, { 0, 1, 2, -1 }, { 2, 1, 2, -1 },      // Uw Rw Fw
+    { 1, 0, 1, 1 }, { 0, 0, 1, 1 }, { 2, 0, 1, 1 },         // Dw Lw Bw
+    { 0, 0, 2, -1 }, { 1, 0, 2, -1 }, { 2, 0, 2, -1 }       // x like R, y like U, z like F
+};
+
+} // namespace
+
+bool Replay::load(int size, const std::string &scramble, const std::string &solution)
+{
+    cubeSize = size;
+    steps.clear();
+    keyframes.clear();
+    if (size < LayerCube::minSize || size > LayerCube::maxSize || !parse(scramble)) {
+        return false;
+    }
+    scrambleSteps = int(steps.size());
+    if (!parse(solution)) {
+        return false;
+    }
+
+    LayerCube cube(size);
+    keyframes.reserve(steps.size() / keyframeInterval + 1);
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (i % keyframeInterval == 0) {
+            keyframes.push_back(cube);
+        }
+        apply(cube, steps[i]);
+    }
+    if (steps.size() % keyframeInterval == 0) {
+        keyframes.push_back(cube);
+    }
+    return true;
+}
+
+bool Replay::parse(const std::string &text)
+{
+    if (cubeSize == 3) {
+        std::vector<Move> moves;
+        if (!parseMoves(text, moves)) {
+            return false;
+        }
+        for (Move move : moves) {
+            Step step = moveSteps[move / 3];
+            step.quarterTurns *= move % 3 == 0 ? 1 : move % 3 == 1 ? 2 : -1;
+            steps.push_back(step);
+        }
+        return true;
+    }
+
+    const char faceNames[] = "URFDLB";
+    size_t i = 0;
+    while (i < text.size()) {
+        if (std::isspace(static_cast<unsigned char>(text[i]))) {
+            ++i;
+            continue;
+        }
+        int depth = 0;
+        bool prefixed = false;
+        while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i]))) {
+            depth = depth * 10 + text[i++] - '0';
+            prefixed = true;
+            if (depth > cubeSize) {
+                return false;
+            }
+        }
+        const char *face = i < text.size() && text[i] ? std::strchr(faceNames, text[i]) : nullptr;
+        if (!face || (prefixed && depth == 0)) {
+            return false;
+        }
+        ++i;
+
+        // Layers counted in from the face: one for "3R", all of the first
+        // three for "3Rw", the first two for "Rw"
+        int first = prefixed ? depth - 1 : 0;
+        int last = first;
+        if (i < text.size() && text[i] == 'w') {
+            ++i;
+            first = 0;
+            last = prefixed ? depth - 1 : 1;
+        }
+        int quarterTurns = 1;
+        if (i < text.size() && text[i] == '2') {
+            quarterTurns = 2;
+            ++i;
+        }
+        if (i < text.size() && text[i] == '\'') {
+            quarterTurns = -quarterTurns;
+            ++i;
+        }
+
+        int index = int(face - faceNames);
+        Step step;
+        step.axis = uint8_t(faceAxes[index]);
+        if (facePositive[index]) {
+            step.firstLayer = uint8_t(cubeSize - 1 - last);
+            step.lastLayer = uint8_t(cubeSize - 1 - first);
+            step.quarterTurns = int8_t(-quarterTurns);
+        } else {
+            step.firstLayer = uint8_t(first);
+            step.lastLayer = uint8_t(last);
+            step.quarterTurns = int8_t(quarterTurns);
+        }
+        steps.push_back(step);
+    }
+    return true;
+}
+
+void Replay::stateAt(int position, LayerCube &cube) const
+{
+    if (keyframes.empty()) {
+        cube = LayerCube(cubeSize);
+        return;
+    }
+    position = std::clamp(position, 0, stepCount());
+    cube = keyframes[position / keyframeInterval];
+    for (int i = position / keyframeInterval * keyframeInterval; i < position; ++i) {
+        apply(cube, steps[i]);
+    }
+}
+
+void Replay::apply(LayerCube &cube, const Step &step, std::vector<int> *moved)
+{
+    if (moved) {
+        moved->clear();
+    }
+    std::vector<int> layer;
+    for (int i = step.firstLayer; i <= step.lastLayer; ++i) {
+        cube.turnLayer(step.axis, i, step.quarterTurns, moved ? &layer : nullptr);
+        if (moved) {
+            moved->insert(moved->end(), layer.begin(), layer.end());
+        }
+    }
+}
+
+Replay::Step Replay::inverse(const Step &step)
+{
+    Step result = step;
+    result.quarterTurns = int8_t(-step.quarterTurns);
+    return result;
+}
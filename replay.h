@@ -0,0 +1,57 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "layercube.h"
+
+// A recorded solve, scramble then solution, as turns of LayerCube layers.
+// The cube is kept every keyframeInterval turns, so the state at any point
+// of the replay is at most keyframeInterval - 1 turns away from a stored
+// one, however long the solve.
+//
+// Moves are read in the cube's own frame. Whole-cube turns made with the
+// mouse while solving are not recorded, so a solve that used them does not
+// replay to a solved cube.
+class Replay
+{
+public:
+    static constexpr int keyframeInterval = 64;
+
+    // Turns layers firstLayer to lastLayer across axis 0 (x), 1 (y) or 2
+    // (z) together, quarterTurns in the right-handed direction
+    struct Step {
+        uint8_t axis;
+        uint8_t firstLayer;
+        uint8_t lastLayer;
+        int8_t quarterTurns;
+    };
+
+    // False if a move cannot be read or the cube has no such layer. The
+    // 3x3x3 takes any move parseMoves reads; other sizes take face turns
+    // with a layer prefix ("3R'") and wide turns ("3Rw2").
+    bool load(int size, const std::string &scramble, const std::string &solution);
+
+    int size() const { return cubeSize; }
+    int stepCount() const { return int(steps.size()); }
+    int scrambleLength() const { return scrambleSteps; }
+    const Step &step(int index) const { return steps[index]; }
+
+    // The cube after the first position steps
+    void stateAt(int position, LayerCube &cube) const;
+
+    static void apply(LayerCube &cube, const Step &step, std::vector<int> *moved = nullptr);
+    static Step inverse(const Step &step);
+
+private:
+    bool parse(const std::string &text);
+
+    int cubeSize = 3;
+    int scrambleSteps = 0;
+    std::vector<Step> steps;
+    std::vector<LayerCube> keyframes;
+};
+
+#endif // REPLAY_H
@@ -1,7 +1,65 @@
 #include "rubikscube.h"
 
-RubiksCube::RubiksCube()
+#include <algorithm>
+#include <random>
+
+#include "notation.h"
+
+namespace {
+
+constexpr double scrambleTurnDuration = 50.0;
+// Big cubes scramble faster, so the whole scramble stays short
+constexpr double scrambleDuration = 2000.0;
+
+// Screen side, the rotationAxises entry it turns around and the angle of a
+// clockwise turn seen from that side
+struct SideAxis {
+    char side;
+    int axis;
+    float clockwiseAngle;
+};
+
+const SideAxis sideAxes[] = {
+    { 'U', 0, -90.0f }, { 'D', 0, 90.0f },
+    { 'F', 1, -90.0f }, { 'B', 1, 90.0f },
+    { 'R', 2, -90.0f }, { 'L', 2, 90.0f }
+};
+
+const SideAxis &sideAxis(char side)
+{
+    for (const SideAxis &entry : sideAxes) {
+        if (entry.side == side) {
+            return entry;
+        }
+    }
+    return sideAxes[0];
+}
+
+char oppositeSide(char side)
+{
+    switch (side) {
+    case 'U': return 'D';
+    case 'D': return 'U';
+    case 'F': return 'B';
+    case 'B': return 'F';
+    case 'R': return 'L';
+    default:  return 'R';
+    }
+}
+
+// "2R" for the second layer from the right and so on
+QString layerPrefix(int depth)
+{
+    return depth > 0 ? QString::number(depth + 1) : QString();
+}
+
+} // namespace
+
+RubiksCube::RubiksCube(int size)
 {
+    std::random_device device;
+    scrambler.seed(uint64_t(device()) << 32 | device());
+
     colors = {
         QVector3D(1.0f, 0.0f, 0.0f), // red
         QVector3D(0.0f, 1.0f, 0.0f), // green
@@ -11,254 +69,294 @@ RubiksCube::RubiksCube()
         QVector3D(1.0f, 1.0f, 1.0f)  // white
     };
 
-    cubes.resize(3);
-    for (auto &cube2D : cubes) {
-        cube2D.resize(3);
-        for (auto &cube1D : cube2D) {
-            cube1D.resize(3);
-        }
-    }
-
     rotationAxises.push_back(QVector3D(0.0f, 1.0f, 0.0f));
     rotationAxises.push_back(QVector3D(0.0f, 0.0f, 1.0f));
     rotationAxises.push_back(QVector3D(1.0f, 0.0f, 0.0f));
+
+    setElementsOfCube(size);
+    clock.start();
 }
 
-void RubiksCube::setElementsOfCube()
+void RubiksCube::setSize(int size)
 {
-    for (int x = 0; x < 3; ++x) {
-        for (int y = 0; y < 3; ++y) {
-            for (int z = 0; z < 3; ++z) {
-                QVector<QVector3D> cubeColors;
-                for (int i = 0; i < 6; ++i)
-                {
-                    cubeColors.push_back(QVector3D(0.3f, 0.3f, 0.3f));
-                }
-                // Assign colors based on the position of the cube
-                if (x == 0) cubeColors[4] = colors[2]; // Blue - left
-                if (x == 2) cubeColors[3] = colors[1]; // Green - right
-                if (y == 0) cubeColors[2] = colors[3]; // Yellow - bottom
-                if (y == 2) cubeColors[1] = colors[5]; // White - top
-                if (z == 0) cubeColors[0] = colors[0]; // Red - back
-                if (z == 2) cubeColors[5] = colors[4]; // Orange - front
-                QVector3D position(x * 0.525f - 0.525f, y * 0.525f - 0.525f, z * 0.525f - 0.525f);
-                CubeGeometry cube(0.25f, cubeColors, position);
-                cubes[x][y][z] = cube;
-            }
+    scrambleString.clear();
+    solutionString.clear();
+    setElementsOfCube(size);
+}
+
+void RubiksCube::setElementsOfCube(int n)
+{
+    layers = LayerCube(n);
+
+    // The cube keeps the extent of the original 3x3x3 whatever its size
+    const float spacing = 3 * 0.525f / n;
+    const float cubieSize = spacing * 0.25f / 0.525f;
+
+    cubes.resize(layers.cubieCount());
+    for (int cubie = 0; cubie < layers.cubieCount(); ++cubie) {
+        int x = layers.homePosition(cubie)[0];
+        int y = layers.homePosition(cubie)[1];
+        int z = layers.homePosition(cubie)[2];
+
+        QVector<QVector3D> cubeColors;
+        for (int i = 0; i < 6; ++i)
+        {
+            cubeColors.push_back(QVector3D(0.3f, 0.3f, 0.3f));
         }
+        // Assign colors based on the position of the cube
+        if (x == 0) cubeColors[4] = colors[2]; // Blue - left
+        if (x == n - 1) cubeColors[3] = colors[1]; // Green - right
+        if (y == 0) cubeColors[2] = colors[3]; // Yellow - bottom
+        if (y == n - 1) cubeColors[1] = colors[5]; // White - top
+        if (z == 0) cubeColors[0] = colors[0]; // Red - back
+        if (z == n - 1) cubeColors[5] = colors[4]; // Orange - front
+        QVector3D position(x - (n - 1) / 2.0f, y - (n - 1) / 2.0f, z - (n - 1) / 2.0f);
+        CubeGeometry cube(cubieSize, cubeColors, position * spacing);
+        cubes[cubie] = cube;
     }
-    solvedCubes = cubes;
+    turns.clear();
+    state = CubeState();
 }
 
 void RubiksCube::rotateAllCubes(QVector3D rotationAxis, bool clockwise)
 {
-    vec3Cube tempCubes = cubes;
-    vec3Cube tempSolvedCubes = solvedCubes;
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            for (int k = 0; k < 3; ++k) {
-                if (rotationAxis.x() != 0.0f) {
-                    if (clockwise) {
-                        cubes[i][j][k] = tempCubes[i][2-k][j];
-                        solvedCubes[i][j][k] = tempSolvedCubes[i][2-k][j];
-                    } else {
-                        cubes[i][j][k] = tempCubes[i][k][2-j];
-                        solvedCubes[i][j][k] = tempSolvedCubes[i][k][2-j];
-                    }
-                } else if (rotationAxis.y() != 0.0f) {
-                    if (clockwise) {
-                        cubes[i][j][k] = tempCubes[k][j][2-i];
-                        solvedCubes[i][j][k] = tempSolvedCubes[k][j][2-i];
-                    } else {
-                        cubes[i][j][k] = tempCubes[2-k][j][i];
-                        solvedCubes[i][j][k] = tempSolvedCubes[2-k][j][i];
-                    }
-                } else {
-                    if (clockwise) {
-                        cubes[i][j][k] = tempCubes[2-j][i][k];
-                        solvedCubes[i][j][k] = tempSolvedCubes[2-j][i][k];
-                    } else {
-                        cubes[i][j][k] = tempCubes[j][2-i][k];
-                        solvedCubes[i][j][k] = tempSolvedCubes[j][2-i][k];
-                    }
-                }
-            }
-        }
+    // The cubies stay where they are in model space, only the mapping of
+    // screen sides to the cube's faces changes
+    if (rotationAxis.x() != 0.0f) {
+        state.rotate('x', clockwise);
+    } else if (rotationAxis.y() != 0.0f) {
+        state.rotate('y', clockwise);
+    } else {
+        state.rotate('z', clockwise);
+    }
+}
+
+void RubiksCube::findLayer(char side, int depth, int &axis, int &layer, int &clockwiseTurns) const
+{
+    // The side's axis in model space, pointing out of the side
+    const SideAxis &entry = sideAxis(side);
+    QVector3D outward = rotationAxises[entry.axis];
+    if (entry.clockwiseAngle > 0.0f) {
+        outward = -outward;
     }
+    axis = qAbs(outward.x()) > 0.5f ? 0 : qAbs(outward.y()) > 0.5f ? 1 : 2;
+    bool positive = outward[axis] > 0.0f;
+    layer = positive ? layers.size() - 1 - depth : depth;
+    // Clockwise seen from outside is clockwise around the outward axis
+    clockwiseTurns = positive ? -1 : 1;
 }
 
-QVector<CubeGeometry *> RubiksCube::getCubesOnSide(char side)
+QVector<CubeGeometry *> RubiksCube::getCubesOnSide(char side, int depth)
 {
+    int axis, layer, clockwiseTurns;
+    findLayer(side, depth, axis, layer, clockwiseTurns);
+    std::vector<int> pieces;
+    layers.layerCubies(axis, layer, pieces);
+
     QVector<CubeGeometry *> cubesOnSide;
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
+    for (int piece : pieces) {
+        cubesOnSide.push_back(&cubes[piece]);
+    }
+    return cubesOnSide;
+}
+
+void RubiksCube::updateCubesAfterRotation(char side, bool clockwise, int depth)
+{
+    // The cubie model only exists for the 3x3x3, the solver's cube
+    if (layers.size() == 3) {
+        if (depth == 0) {
+            state.turnFace(side, clockwise);
+        } else if (depth == 2) {
+            state.turnFace(oppositeSide(side), !clockwise);
+        } else {
+            // M turns like L, E like D and S like F
+            Move slice;
+            bool withSlice = side == 'L' || side == 'D' || side == 'F';
             switch (side) {
-            case 'U': cubesOnSide.push_back(&cubes[i][2][j]); break;
-            case 'D': cubesOnSide.push_back(&cubes[i][0][j]); break;
-            case 'L': cubesOnSide.push_back(&cubes[0][i][j]); break;
-            case 'R': cubesOnSide.push_back(&cubes[2][i][j]); break;
-            case 'F': cubesOnSide.push_back(&cubes[i][j][2]); break;
-            case 'B': cubesOnSide.push_back(&cubes[i][j][0]); break;
-            default: break;
+            case 'L': case 'R': slice = MoveM; break;
+            case 'D': case 'U': slice = MoveE; break;
+            default:            slice = MoveS; break;
             }
+            state.apply(Move(slice + (clockwise == withSlice ? 0 : 2)));
         }
     }
-    return cubesOnSide;
+    checkForSolved();
 }
 
-void RubiksCube::updateCubesAfterRotation(char side, bool clockwise)
+QQuaternion RubiksCube::sideRotation(char side, bool clockwise) const
 {
-    switch (side) {
-    case 'U': rotateFace(cubes, side, 2, clockwise, false, true); break;
-    case 'D': rotateFace(cubes, side, 0, clockwise, false, true); break;
-    case 'L': rotateFace(cubes, side, 0, clockwise, true, false); break;
-    case 'R': rotateFace(cubes, side, 2, clockwise, true, false); break;
-    case 'F': rotateFace(cubes, side, 2, clockwise, false, false); break;
-    case 'B': rotateFace(cubes, side, 0, clockwise, false, false); break;
+    const SideAxis &entry = sideAxis(side);
+    float angle = clockwise ? entry.clockwiseAngle : -entry.clockwiseAngle;
+    return QQuaternion::fromAxisAndAngle(rotationAxises[entry.axis], angle);
+}
+
+void RubiksCube::rotateSide(QQuaternion rotation, char side, bool clockwise)
+{
+    turnLayer(rotation, side, 0, clockwise, turnDuration);
+}
+
+void RubiksCube::rotateLayer(QQuaternion rotation, char side, int depth, bool clockwise)
+{
+    turnLayer(rotation, side, depth, clockwise, turnDuration);
+}
+
+void RubiksCube::turnLayer(QQuaternion rotation, char side, int depth, bool clockwise, double duration)
+{
+    if (depth < 0 || depth >= layers.size()) {
+        return;
     }
+    int axis, layer, clockwiseTurns;
+    findLayer(side, depth, axis, layer, clockwiseTurns);
+
+    Turn turn;
+    layers.turnLayer(axis, layer, clockwise ? clockwiseTurns : -clockwiseTurns, &turn.pieces);
+    turn.rotation = rotation.normalized();
+    turn.duration = duration;
+    turn.start = clock.nsecsElapsed() / 1e6;
+    for (int piece : turn.pieces) {
+        cubes[piece].rotateCube(rotation);
+    }
+    turns.enqueue(turn);
+    emit cubesMoved();
+    updateCubesAfterRotation(side, clockwise, depth);
+}
+
+void RubiksCube::setTurnsPerSecond(double turnsPerSecond)
+{
+    turnDuration = 1000.0 / qMax(turnsPerSecond, 0.1);
 }
 
-void RubiksCube::rotateFace(vec3Cube &cubes, char side, int layer, bool clockwise, bool rotateX, bool rotateY)
+bool RubiksCube::animate()
 {
-    vec3Cube tempCubes = cubes;
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            if (rotateX) { // Rotate around X-axis (L/R)
-                if (clockwise) {
-                    if (side == 'R') {
-                        cubes[layer][j][i] = tempCubes[layer][2-i][j];
-                    } else {
-                        cubes[layer][j][i] = tempCubes[layer][i][2-j];
-                    }
-                } else {
-                    if (side == 'R') {
-                        cubes[layer][j][i] = tempCubes[layer][i][2-j];
-                    } else {
-                        cubes[layer][j][i] = tempCubes[layer][2-i][j];
-                    }
-                }
-            } else if (rotateY) { // Rotate around Y-axis (U/D)
-                if (clockwise) {
-                    if (side == 'U') {
-                        cubes[i][layer][j] = tempCubes[j][layer][2-i];
-                    } else {
-                        cubes[i][layer][j] = tempCubes[2-j][layer][i];
-                    }
-                } else {
-                    if (side == 'U') {
-                        cubes[i][layer][j] = tempCubes[2-j][layer][i];
-                    } else {
-                        cubes[i][layer][j] = tempCubes[j][layer][2-i];
-                    }
-                }
-            } else { // Rotate around Z-axis (F/B)
-                if (clockwise) {
-                    if (side == 'F') {
-                        cubes[i][j][layer] = tempCubes[2-j][i][layer];
-                    } else {
-                        cubes[i][j][layer] = tempCubes[j][2-i][layer];
-                    }
-                } else {
-                    if (side == 'F') {
-                        cubes[i][j][layer] = tempCubes[j][2-i][layer];
-                    } else {
-                        cubes[i][j][layer] = tempCubes[2-j][i][layer];
-                    }
-                }
+    const double now = clock.nsecsElapsed() / 1e6;
+    while (!turns.isEmpty()) {
+        Turn &turn = turns.head();
+        if (turn.from.isEmpty()) {
+            for (int piece : turn.pieces) {
+                turn.from.push_back(cubes[piece].GetRotation());
             }
         }
+
+        double progress = (now - turn.start) / turn.duration;
+        if (progress < 1.0) {
+            QQuaternion partial = QQuaternion::slerp(QQuaternion(), turn.rotation, float(progress));
+            for (size_t i = 0; i < turn.pieces.size(); ++i) {
+                cubes[turn.pieces[i]].SetRotation(partial * turn.from[i]);
+            }
+            return true;
+        }
+
+        // Land exactly on the turn, the same product rotateCube() built for
+        // the target, and start the next one where this one ended
+        for (size_t i = 0; i < turn.pieces.size(); ++i) {
+            cubes[turn.pieces[i]].SetRotation(turn.rotation * turn.from[i]);
+        }
+        double end = turn.start + turn.duration;
+        turns.dequeue();
+        if (!turns.isEmpty()) {
+            turns.head().start = qMax(turns.head().start, end);
+        }
     }
-    checkForSolved();
+    return false;
 }
 
-void RubiksCube::rotateSide(QQuaternion rotation, char side, bool clockwise)
+void RubiksCube::scramble(const std::vector<Move> &moves)
 {
-    QVector<CubeGeometry*> cubesOnSide;
-    cubesOnSide = getCubesOnSide(side);
-    for (auto &cube : cubesOnSide) {
-        cube->rotateCube(rotation);
+    // The turns are in the cube's own frame, the scramble is written down
+    // as the sides they are seen on
+    std::vector<Move> seen;
+    seen.reserve(moves.size());
+    for (Move move : moves) {
+        int side = QByteArray("URFDLB").indexOf(state.sideOf(Face(move / 3)));
+        seen.push_back(Move(side * 3 + move % 3));
+        playMove(move, scrambleTurnDuration);
     }
-    updateCubesAfterRotation(side, clockwise);
+    scrambleString += QString::fromStdString(formatMoves(seen)) + ' ';
+}
+
+RandomScrambler RubiksCube::newScrambler()
+{
+    return RandomScrambler(scrambler.random(UINT64_MAX), scrambler.random(UINT64_MAX));
 }
 
 void RubiksCube::scramble()
 {
+    const int n = layers.size();
+
+    // 11 turns for the 2x2x2, 20 for every layer above two
+    const int count = n == 2 ? 11 : 20 * (n - 2);
+    const double duration = qMin(scrambleTurnDuration, scrambleDuration / count);
+
     QVector<char> moves = {'U', 'D', 'L', 'R', 'F', 'B'};
     QVector<char> lastThreeMoves(3, 0);
-    int angle;
-    for (int i = 0; i < 20; ++i) {
+    for (int i = 0; i < count; ++i) {
         int side;
 
         do {
-            side = rand() % 6;
+            side = int(scrambler.random(6));
         } while (std::count(lastThreeMoves.begin(), lastThreeMoves.end(), moves[side]) > 1);
         std::rotate(lastThreeMoves.begin(), lastThreeMoves.begin() + 1, lastThreeMoves.end());
         lastThreeMoves[0] = moves[side];
 
-        int clockwise = rand() % 2;
-        switch (side) {
-        case 0:
-            if (clockwise) {
-                angle = -90.0f;
-                scrambleString += "U ";
-            } else {
-                angle = 90.0f;
-                scrambleString += "U' ";
-            }
-            rotateSide(QQuaternion::fromAxisAndAngle(rotationAxises[0], angle), 'U', clockwise);
-            break;
-        case 1:
-            if (clockwise) {
-                angle = 90.0f;
-                scrambleString += "D ";
-            } else {
-                angle = -90.0f;
-                scrambleString += "D' ";
-            }
-            rotateSide(QQuaternion::fromAxisAndAngle(rotationAxises[0], angle), 'D', clockwise);
-            break;
-        case 2:
-            if (clockwise) {
-                angle = 90.0f;
-                scrambleString += "L ";
-            } else {
-                angle = -90.0f;
-                scrambleString += "L' ";
-            }
-            rotateSide(QQuaternion::fromAxisAndAngle(rotationAxises[2], angle), 'L', clockwise);
-            break;
-        case 3:
-            if (clockwise) {
-                angle = -90.0f;
-                scrambleString += "R ";
-            } else {
-                angle = 90.0f;
-                scrambleString += "R' ";
-            }
-            rotateSide(QQuaternion::fromAxisAndAngle(rotationAxises[2], angle), 'R', clockwise);
-            break;
-        case 4:
-            if (clockwise) {
-                angle = -90.0f;
-                scrambleString += "F ";
-            } else {
-                angle = 90.0f;
-                scrambleString += "F' ";
-            }
-            rotateSide(QQuaternion::fromAxisAndAngle(rotationAxises[1], angle), 'F', clockwise);
-            break;
-        case 5:
-            if (clockwise) {
-                angle = 90.0f;
-                scrambleString += "B ";
-            } else {
-                angle = -90.0f;
-                scrambleString += "B' ";
-            }
-            rotateSide(QQuaternion::fromAxisAndAngle(rotationAxises[1], angle), 'B', clockwise);
-            break;
+        // Any layer up to the middle, outer layers only on the 2x2x2
+        int depth = n > 3 ? int(scrambler.random(n / 2)) : 0;
+        bool clockwise = scrambler.random(2);
+        scrambleString += layerPrefix(depth) + moves[side] + (clockwise ? " " : "' ");
+        turnLayer(sideRotation(moves[side], clockwise), moves[side], depth, clockwise, duration);
+    }
+}
+
+void RubiksCube::playMove(Move move)
+{
+    playMove(move, turnDuration);
+}
+
+void RubiksCube::playMove(Move move, double duration)
+{
+    char side = state.sideOf(Face(move / 3));
+    bool clockwise = move % 3 != 2;
+    int quarterTurns = move % 3 == 1 ? 2 : 1;
+
+    for (int i = 0; i < quarterTurns; ++i) {
+        turnLayer(sideRotation(side, clockwise), side, 0, clockwise, duration);
+    }
+}
+
+void RubiksCube::showState(const LayerCube &cube)
+{
+    if (cube.size() != layers.size()) {
+        return;
+    }
+    layers = cube;
+    turns.clear();
+    for (int cubie = 0; cubie < layers.cubieCount(); ++cubie) {
+        const int8_t *matrix = LayerCube::rotationMatrix(layers.orientation(cubie));
+        float values[9];
+        for (int i = 0; i < 9; ++i) {
+            values[i] = matrix[i];
         }
+        QQuaternion rotation = QQuaternion::fromRotationMatrix(QMatrix3x3(values));
+        cubes[cubie].SetRotation(rotation);
+        cubes[cubie].SetTargetRotation(rotation);
+    }
+    emit cubesMoved();
+}
+
+void RubiksCube::playStep(const Replay::Step &step)
+{
+    static const QVector3D axes[3] = {
+        QVector3D(1.0f, 0.0f, 0.0f), QVector3D(0.0f, 1.0f, 0.0f), QVector3D(0.0f, 0.0f, 1.0f)
+    };
+    Turn turn;
+    Replay::apply(layers, step, &turn.pieces);
+    turn.rotation = QQuaternion::fromAxisAndAngle(axes[step.axis], 90.0f * step.quarterTurns);
+    turn.duration = turnDuration;
+    turn.start = clock.nsecsElapsed() / 1e6;
+    for (int piece : turn.pieces) {
+        cubes[piece].rotateCube(turn.rotation);
     }
+    turns.enqueue(turn);
+    emit cubesMoved();
 }
 
 QString RubiksCube::getScramble()
@@ -278,16 +376,9 @@ QString RubiksCube::getSolution()
 
 void RubiksCube::checkForSolved()
 {
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            for (int k = 0; k < 3; ++k) {
-                if (cubes[i][j][k].GetPosition() != solvedCubes[i][j][k].GetPosition()) {
-                    return;
-                }
-            }
-        }
+    if (layers.isSolved()) {
+        emit cubeSolved();
     }
-    emit cubeSolved();
 }
 
 void RubiksCube::changeRotationAxis(QVector3D axis, int index)
@@ -1,31 +1,77 @@
 #ifndef RUBIKSCUBE_H
 #define RUBIKSCUBE_H
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QQueue>
 
-#include "cubegeometry.h"
-
-#define vec3Cube QVector<QVector<QVector<CubeGeometry>>> // 3x3x3 cube
+#include <vector>
 
+#include "cubegeometry.h"
+#include "cubestate.h"
+#include "layercube.h"
+#include "randomscrambler.h"
+#include "replay.h"
+
+// Cube of 2 to 20 layers: the cubies to draw, the turns queued for their
+// animation and the logical state. Sides and layers are picked as seen on
+// screen. Only the 3x3x3 also keeps a CubeState, for the solver.
 class RubiksCube : public QObject
 {
     Q_OBJECT
 public:
-    RubiksCube();
+    explicit RubiksCube(int size = 3);
 
-    void setElementsOfCube();
+    // Starts over with a solved cube of another size
+    void setSize(int size);
+    int getSize() const { return layers.size(); }
 
-    void rotateAllCubes(QVector3D rotationAxis, bool clockwise);
+    // Solved cube of n layers and the cubies that draw it
+    void setElementsOfCube(int n);
 
-    QVector<CubeGeometry *> getCubesOnSide(char side);
+    void rotateAllCubes(QVector3D rotationAxis, bool clockwise);
 
-    void updateCubesAfterRotation(char side, bool clockwise);
+    // depth counts the layers in from the side, 0 is the side itself
+    QVector<CubeGeometry *> getCubesOnSide(char side, int depth = 0);
 
-    void rotateFace(vec3Cube &cubes, char side, int layer, bool clockwise, bool rotateX, bool rotateY);
+    void updateCubesAfterRotation(char side, bool clockwise, int depth = 0);
 
+    // Turns the side at once; the cubies follow after the turns queued
+    // before it have been animated
     void rotateSide(QQuaternion rotation, char side, bool clockwise);
+    void rotateLayer(QQuaternion rotation, char side, int depth, bool clockwise);
+
+    // Rotation of a clockwise or counterclockwise turn of a side
+    QQuaternion sideRotation(char side, bool clockwise) const;
+
+    // Speed of the turn animations, scrambles always run at 20 turns per second
+    void setTurnsPerSecond(double turnsPerSecond);
+    double getTurnsPerSecond() const { return 1000.0 / turnDuration; }
+    int getTurnDuration() const { return qRound(turnDuration); }
 
+    // Moves the cubies to where the queued turns are now; false once every
+    // cubie shows its final rotation
+    bool animate();
+
+    // Random turns; the 3x3x3 takes a random-state scramble instead, which
+    // needs a solve and is worked out off the GUI thread by a scrambler of
+    // newScrambler(), then played with scramble(moves)
     void scramble();
+    void scramble(const std::vector<Move> &moves);
+
+    // Seeded from the cube's own generator
+    RandomScrambler newScrambler();
+
+    bool isSolved() const { return layers.isSolved(); }
+
+    // Animated face turn of the cube's own frame, whichever side it is seen on
+    void playMove(Move move);
+
+    // Replays: shows a state at once or animates a step, without the
+    // solved check and without the CubeState, which is reset with the cube
+    // when the replay ends
+    void showState(const LayerCube &cube);
+    void playStep(const Replay::Step &step);
 
     QString getScramble();
 
@@ -35,23 +81,53 @@ public:
 
     void checkForSolved();
 
-    vec3Cube &getCubes() { return cubes; }
+    QVector<CubeGeometry> &getCubes() { return cubes; }
+
+    const CubeState &getState() const { return state; }
+    const LayerCube &getLayers() const { return layers; }
 
     void changeRotationAxis(QVector3D axis, int index);
 
 signals:
     void cubeSolved();
+    // A turn was queued, so the cubies have to be animated
+    void cubesMoved();
 
 private:
-    vec3Cube cubes;
+    // A quarter turn waiting for or in the middle of its animation. It
+    // starts when it was queued or when the turn before it ended, whichever
+    // is later; times are milliseconds of clock.
+    struct Turn {
+        std::vector<int> pieces;
+        QQuaternion rotation;
+        double duration;
+        double start;
+        // Rotations of the pieces when the animation started
+        QVector<QQuaternion> from;
+    };
+
+    // Layer of the model that is depth layers in from a screen side, and
+    // the quarter turns around its axis that turn it clockwise
+    void findLayer(char side, int depth, int &axis, int &layer, int &clockwiseTurns) const;
+    void turnLayer(QQuaternion rotation, char side, int depth, bool clockwise, double duration);
+    void playMove(Move move, double duration);
+
+    // Cubies indexed like the cubies of layers
+    QVector<CubeGeometry> cubes;
+    LayerCube layers;
+    CubeState state;
     QVector<QVector3D> colors;
 
     QVector<QVector3D> rotationAxises;
 
+    // Random turns, and the seeds of newScrambler()
+    RandomScrambler scrambler;
     QString scrambleString;
     QString solutionString;
 
-    vec3Cube solvedCubes;
+    QQueue<Turn> turns;
+    QElapsedTimer clock;
+    double turnDuration = 150.0;
 };
 
 #endif // RUBIKSCUBE_H
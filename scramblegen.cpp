@@ -0,0 +1,84 @@
+// Writes random-state scrambles, one per line, on all cores. A seed fixes
+// the whole series, so a run can be repeated or continued with --first
+// whatever the number of threads.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+#include "notation.h"
+#include "randomscrambler.h"
+#include "twophasesolver.h"
+#include "workstealingpool.h"
+
+namespace {
+
+// Scrambles are generated and written this many at a time
+constexpr qint64 batchSize = 16384;
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates random-state scrambles of the 3x3x3");
+    parser.addHelpOption();
+    QCommandLineOption countOption({ "n", "count" }, "Scrambles to generate.", "count", "1000");
+    QCommandLineOption seedOption("seed", "Seed of the series.", "seed", "0");
+    QCommandLineOption firstOption("first", "Index of the first scramble in the series.", "index", "0");
+    QCommandLineOption outputOption({ "o", "output" }, "Output file, standard output if omitted.", "file");
+    QCommandLineOption threadsOption("threads", "Worker threads, 0 for one per core.", "threads", "0");
+    QCommandLineOption lengthOption("max-length", "Longest scramble.", "moves",
+                                    QString::number(RandomScrambler::defaultLength));
+    parser.addOptions({ countOption, seedOption, firstOption, outputOption, threadsOption, lengthOption });
+    parser.process(app);
+
+    QFile outputFile;
+    if (parser.isSet(outputOption)) {
+        outputFile.setFileName(parser.value(outputOption));
+        if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            err << "cannot open " << outputFile.fileName() << "\n";
+            return 1;
+        }
+    } else {
+        outputFile.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+    QTextStream out(&outputFile);
+
+    const qint64 count = parser.value(countOption).toLongLong();
+    const quint64 seed = parser.value(seedOption).toULongLong();
+    const quint64 first = parser.value(firstOption).toULongLong();
+    const int maxLength = parser.value(lengthOption).toInt();
+    WorkStealingPool pool(parser.value(threadsOption).toInt());
+
+    QElapsedTimer timer;
+    timer.start();
+    TwoPhaseSolver::instance();
+    err << "tables ready in " << timer.elapsed() << " ms, generating on " << pool.threadCount() << " threads\n" << Qt::flush;
+
+    timer.start();
+    std::vector<std::vector<Move>> scrambles;
+    qint64 moves = 0;
+    for (qint64 done = 0; done < count; done += qint64(scrambles.size())) {
+        scrambles.assign(size_t(std::min(batchSize, count - done)), std::vector<Move>());
+        RandomScrambler::generate(seed, first + done, scrambles, pool, maxLength);
+        for (const std::vector<Move> &scramble : scrambles) {
+            out << QString::fromStdString(formatMoves(scramble)) << '\n';
+            moves += qint64(scramble.size());
+        }
+        out.flush();
+    }
+
+    double seconds = timer.elapsed() / 1000.0;
+    err << count << " scrambles in " << QString::number(seconds, 'f', 2) << " s ("
+        << QString::number(seconds > 0.0 ? count / seconds : 0.0, 'f', 1) << " per second, "
+        << QString::number(count > 0 ? double(moves) / count : 0.0, 'f', 2) << " moves on average)\n";
+    return 0;
+}
@@ -0,0 +1,15 @@
+# Series of random-state scrambles for training data, some 10^4 a minute
+# per core
+# Build it like the application: qmake scramblegen.pro && make
+
+QT       += core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = scramblegen
+
+include(cubecore.pri)
+
+SOURCES += \
+    scramblegen.cpp
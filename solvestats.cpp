@@ -0,0 +1,120 @@
+#include "solvestats.h"
+
+#include <iterator>
+
+const int SolveStats::averageSizes[averageCount] = { 5, 12, 50, 100, 1000 };
+
+SolveStats::SolveStats()
+    : averages{ TrimmedWindow(averageSizes[0]), TrimmedWindow(averageSizes[1]), TrimmedWindow(averageSizes[2]),
+                TrimmedWindow(averageSizes[3]), TrimmedWindow(averageSizes[4]) }
+{
+}
+
+void SolveStats::add(int64_t time)
+{
+    ++solveCount;
+    sum += time;
+    if (bestTime < 0 || time < bestTime) {
+        bestTime = time;
+    }
+    for (TrimmedWindow &window : averages) {
+        window.add(time);
+    }
+}
+
+void SolveStats::clear()
+{
+    solveCount = 0;
+    sum = 0;
+    bestTime = -1;
+    for (TrimmedWindow &window : averages) {
+        window.clear();
+    }
+}
+
+SolveStats::TrimmedWindow::TrimmedWindow(int size)
+    : size(size)
+    , trim((size + 19) / 20)
+{
+}
+
+void SolveStats::TrimmedWindow::add(int64_t time)
+{
+    times.push_back(time);
+    insert(time);
+    if (int(times.size()) > size) {
+        erase(times.front());
+        times.pop_front();
+    }
+    if (int(times.size()) == size) {
+        current = double(middleSum) / (size - 2 * trim);
+        if (best < 0.0 || current < best) {
+            best = current;
+        }
+    }
+}
+
+// fastest <= middle <= slowest throughout, and the outer sets hold trim
+// times each once there are enough
+void SolveStats::TrimmedWindow::insert(int64_t time)
+{
+    if (!fastest.empty() && time < *fastest.rbegin()) {
+        fastest.insert(time);
+        toMiddle(fastest, std::prev(fastest.end()));
+    } else if (!slowest.empty() && time > *slowest.begin()) {
+        slowest.insert(time);
+        toMiddle(slowest, slowest.begin());
+    } else {
+        middle.insert(time);
+        middleSum += time;
+    }
+    while (int(fastest.size()) < trim && !middle.empty()) {
+        fromMiddle(fastest, middle.begin());
+    }
+    while (int(slowest.size()) < trim && !middle.empty()) {
+        fromMiddle(slowest, std::prev(middle.end()));
+    }
+}
+
+void SolveStats::TrimmedWindow::erase(int64_t time)
+{
+    if (!fastest.empty() && time <= *fastest.rbegin()) {
+        fastest.erase(fastest.find(time));
+        if (!middle.empty()) {
+            fromMiddle(fastest, middle.begin());
+        }
+    } else if (!slowest.empty() && time >= *slowest.begin()) {
+        slowest.erase(slowest.find(time));
+        if (!middle.empty()) {
+            fromMiddle(slowest, std::prev(middle.end()));
+        }
+    } else {
+        middle.erase(middle.find(time));
+        middleSum -= time;
+    }
+}
+
+void SolveStats::TrimmedWindow::toMiddle(std::multiset<int64_t> &from, std::multiset<int64_t>::iterator it)
+{
+    middleSum += *it;
+    middle.insert(*it);
+    from.erase(it);
+}
+
+void SolveStats::TrimmedWindow::fromMiddle(std::multiset<int64_t> &to, std::multiset<int64_t>::iterator it)
+{
+    middleSum -= *it;
+    to.insert(*it);
+    middle.erase(it);
+}
+
+void SolveStats::TrimmedWindow::clear()
+{
+    times.clear();
+    fastest.clear();
+    middle.clear();
+    slowest.clear();
+    middleSum = 0;
+    current = -1.0;
+    best = -1.0;
+}
@@ -0,0 +1,63 @@
+#ifndef SOLVESTATS_H
+#define SOLVESTATS_H
+
+#include <cstdint>
+#include <deque>
+#include <set>
+
+// Statistics speedcubers keep over their solve times, updated as each time
+// comes in: the mean, the best single and the current and best average of
+// the last 5, 12, 50, 100 and 1000 solves. An average drops the best and
+// the worst 5% of its solves, rounded up, like the WCA does for ao5 and
+// ao12. Adding a time costs O(log n) for an average of n, however many
+// solves came before. Times are in milliseconds; -1 means there have not
+// been enough solves yet.
+class SolveStats
+{
+public:
+    static constexpr int averageCount = 5;
+    static const int averageSizes[averageCount];
+
+    SolveStats();
+
+    void add(int64_t time);
+    void clear();
+
+    int count() const { return solveCount; }
+    double mean() const { return solveCount > 0 ? double(sum) / solveCount : -1.0; }
+    int64_t best() const { return bestTime; }
+
+    // Of the last averageSizes[i] solves
+    double average(int i) const { return averages[i].current; }
+    double bestAverage(int i) const { return averages[i].best; }
+
+private:
+    // Times of the last size solves split into the trim fastest, the trim
+    // slowest and the ones in between, whose sum makes the average
+    struct TrimmedWindow {
+        int size;
+        int trim;
+        std::deque<int64_t> times;
+        std::multiset<int64_t> fastest;
+        std::multiset<int64_t> middle;
+        std::multiset<int64_t> slowest;
+        int64_t middleSum = 0;
+        double current = -1.0;
+        double best = -1.0;
+
+        explicit TrimmedWindow(int size);
+        void add(int64_t time);
+        void insert(int64_t time);
+        void erase(int64_t time);
+        void toMiddle(std::multiset<int64_t> &from, std::multiset<int64_t>::iterator it);
+        void fromMiddle(std::multiset<int64_t> &to, std::multiset<int64_t>::iterator it);
+        void clear();
+    };
+
+    TrimmedWindow averages[averageCount];
+    int solveCount = 0;
+    int64_t sum = 0;
+    int64_t bestTime = -1;
+};
+
+#endif // SOLVESTATS_H
@@ -0,0 +1,188 @@
+#include "statekernel.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STATEKERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*TurnFunction)(uint8_t *cubies, const Move *moves, size_t count);
+
+// (twist % 3) << 4 for a twist sum in 0..4
+const uint8_t twistNibble[5] = { 0x00, 0x10, 0x20, 0x00, 0x10 };
+
+void turnScalar(uint8_t *cubies, const Move *moves, size_t count)
+{
+    uint8_t *corners = cubies;
+    uint8_t *edges = cubies + 8;
+    for (size_t n = 0; n < count; ++n) {
+        const MoveTables::CubieMove &move = MoveTables::faceTurns.moves[moves[n]];
+        uint8_t c[8];
+        uint8_t e[12];
+        std::memcpy(c, corners, sizeof(c));
+        std::memcpy(e, edges, sizeof(e));
+        for (int i = 0; i < 8; ++i) {
+            uint8_t piece = c[move.cornerPerm[i]];
+            corners[i] = (piece & 0x0f) | twistNibble[(piece >> 4) + move.cornerTwist[i]];
+        }
+        for (int i = 0; i < 12; ++i) {
+            edges[i] = e[move.edgePerm[i]] ^ (move.edgeFlip[i] << 4);
+        }
+    }
+}
+
+#ifdef STATEKERNEL_X86
+
+// Every face turn and noTurn as two 128-bit lanes: the corners in the first,
+// the edges in the second. A turn shuffles the bytes and adds the
+// orientation change, then takes the orientation mod limit.
+struct Shuffles {
+    alignas(32) uint8_t perm[faceTurnCount + 1][32];
+    alignas(32) uint8_t orientation[faceTurnCount + 1][32];
+    alignas(32) uint8_t limit[32];
+
+    Shuffles()
+    {
+        for (int move = 0; move <= faceTurnCount; ++move) {
+            const MoveTables::CubieMove &cubieMove = MoveTables::faceTurns.moves[move];
+            for (int i = 0; i < 16; ++i) {
+                // Bytes 8..15 of the corner lane are zeroed, the last four
+                // of the edge lane are not the cube's and stay in place
+                perm[move][i] = i < 8 ? cubieMove.cornerPerm[i] : 0x80;
+                orientation[move][i] = i < 8 ? cubieMove.cornerTwist[i] << 4 : 0;
+                perm[move][16 + i] = i < 12 ? cubieMove.edgePerm[i] : i;
+                orientation[move][16 + i] = i < 12 ? cubieMove.edgeFlip[i] << 4 : 0;
+            }
+        }
+        for (int i = 0; i < 16; ++i) {
+            limit[i] = 0x30;
+            limit[16 + i] = 0x20;
+        }
+    }
+};
+
+const Shuffles &shuffles()
+{
+    static const Shuffles instance;
+    return instance;
+}
+
+__attribute__((target("ssse3")))
+void turnSsse3(uint8_t *cubies, const Move *moves, size_t count)
+{
+    const Shuffles &table = shuffles();
+    __m128i corners = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(cubies));
+    __m128i edges = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cubies + 8));
+    const __m128i three = _mm_set1_epi8(0x30);
+    const __m128i two = _mm_set1_epi8(0x2f);
+    for (size_t n = 0; n < count; ++n) {
+        const __m128i *perm = reinterpret_cast<const __m128i *>(table.perm[moves[n]]);
+        const __m128i *orientation = reinterpret_cast<const __m128i *>(table.orientation[moves[n]]);
+        corners = _mm_add_epi8(_mm_shuffle_epi8(corners, _mm_load_si128(perm)), _mm_load_si128(orientation));
+        corners = _mm_sub_epi8(corners, _mm_and_si128(_mm_cmpgt_epi8(corners, two), three));
+        // A flip twice cancels, so edges need no mod
+        edges = _mm_xor_si128(_mm_shuffle_epi8(edges, _mm_load_si128(perm + 1)), _mm_load_si128(orientation + 1));
+    }
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(cubies), corners);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(cubies + 8), edges);
+}
+
+__attribute__((target("avx2")))
+void turnAvx2(uint8_t *cubies, const Move *moves, size_t count)
+{
+    const Shuffles &table = shuffles();
+    __m256i cube = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(cubies))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(cubies + 8)), 1);
+    const __m256i limit = _mm256_load_si256(reinterpret_cast<const __m256i *>(table.limit));
+    const __m256i belowLimit = _mm256_sub_epi8(limit, _mm256_set1_epi8(1));
+    for (size_t n = 0; n < count; ++n) {
+        // vpshufb shuffles within each lane, which is all a turn needs
+        cube = _mm256_add_epi8(
+            _mm256_shuffle_epi8(cube, _mm256_load_si256(reinterpret_cast<const __m256i *>(table.perm[moves[n]]))),
+            _mm256_load_si256(reinterpret_cast<const __m256i *>(table.orientation[moves[n]])));
+        cube = _mm256_sub_epi8(cube, _mm256_and_si256(_mm256_cmpgt_epi8(cube, belowLimit), limit));
+    }
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(cubies), _mm256_castsi256_si128(cube));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(cubies + 8), _mm256_extracti128_si256(cube, 1));
+}
+
+#endif // STATEKERNEL_X86
+
+const TurnFunction turnFunctions[StateKernel::BackendCount] = {
+    turnScalar,
+#ifdef STATEKERNEL_X86
+    turnSsse3,
+    turnAvx2
+#else
+    nullptr,
+    nullptr
+#endif
+};
+
+StateKernel::Backend bestBackend()
+{
+    for (int backend = StateKernel::BackendCount - 1; backend > StateKernel::Scalar; --backend) {
+        if (StateKernel::isSupported(StateKernel::Backend(backend))) {
+            return StateKernel::Backend(backend);
+        }
+    }
+    return StateKernel::Scalar;
+}
+
+std::atomic<int> &selected()
+{
+    static std::atomic<int> backend(bestBackend());
+    return backend;
+}
+
+} // namespace
+
+namespace StateKernel {
+
+const char *backendName(Backend backend)
+{
+    static const char *const names[BackendCount] = { "scalar", "SSSE3", "AVX2" };
+    return backend >= 0 && backend < BackendCount ? names[backend] : "";
+}
+
+bool isSupported(Backend backend)
+{
+    switch (backend) {
+    case Scalar:
+        return true;
+#ifdef STATEKERNEL_X86
+    case Ssse3:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+    case Avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+Backend backend()
+{
+    return Backend(selected().load(std::memory_order_relaxed));
+}
+
+void setBackend(Backend backend)
+{
+    if (isSupported(backend)) {
+        selected().store(backend, std::memory_order_relaxed);
+    }
+}
+
+void turn(uint8_t *cubies, const Move *moves, size_t count)
+{
+    turnFunctions[selected().load(std::memory_order_relaxed)](cubies, moves, count);
+}
+
+} // namespace StateKernel
@@ -0,0 +1,40 @@
+#ifndef STATEKERNEL_H
+#define STATEKERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "movetables.h"
+
+// Face turns on the byte state of CubeState: 8 corners, then 12 edges, each
+// byte the piece in the low nibble and its orientation in the high one.
+//
+// The SIMD backends hold the corners and the edges in vector registers and
+// apply a turn as one byte shuffle (pshufb) per register plus an
+// orientation add and mod, keeping the registers across a whole sequence.
+// The fastest backend the processor supports is picked on first use.
+namespace StateKernel {
+
+enum Backend {
+    Scalar,
+    Ssse3,      // corners and edges in two 128-bit registers
+    Avx2,       // both in one 256-bit register, one lane each
+    BackendCount
+};
+
+const char *backendName(Backend backend);
+bool isSupported(Backend backend);
+
+Backend backend();
+
+// For benchmarks and comparisons; unsupported backends are ignored
+void setBackend(Backend backend);
+
+// Applies moves (face turns, or noTurn which does nothing) one after the
+// other. The 20 bytes of cubies must be followed by 4 more that can be
+// read; the vector backends load and store them back unchanged.
+void turn(uint8_t *cubies, const Move *moves, size_t count);
+
+} // namespace StateKernel
+
+#endif // STATEKERNEL_H
@@ -0,0 +1,264 @@
+#include "tablefile.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char magic[8] = { 'C', 'U', 'B', 'E', 'T', 'B', 'L', '\0' };
+constexpr quint32 formatVersion = 2;
+constexpr qint64 alignment = 64;
+
+struct Header {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 tableVersion;
+    quint32 tableCount;
+    quint32 reserved;
+    quint64 checksum;       // over the entries
+};
+
+struct Entry {
+    char name[24];
+    quint64 offset;         // from the start of the file
+    quint64 size;
+    quint64 checksum;       // over the table's bytes
+};
+
+// The table is read in pieces of this size, so a destructor that stops the
+// check need not wait long
+constexpr qint64 verifyChunk = 1 << 20;
+
+QString tableDirectory;
+
+// FNV-1a over 64-bit words
+class Checksum
+{
+public:
+    void add(const uchar *bytes, qint64 size)
+    {
+        qint64 i = 0;
+        // Complete a word left over from the previous call first
+        while (pendingSize > 0 && i < size) {
+            pending[pendingSize++] = bytes[i++];
+            if (pendingSize == 8) {
+                mix(pending);
+                pendingSize = 0;
+            }
+        }
+        for (; i + 8 <= size; i += 8) {
+            mix(bytes + i);
+        }
+        while (i < size) {
+            pending[pendingSize++] = bytes[i++];
+        }
+    }
+
+    // Mixes in a word left pending with zeros, as if the data were padded
+    quint64 value() const
+    {
+        if (pendingSize == 0) {
+            return hash;
+        }
+        uchar word[8] = {};
+        std::memcpy(word, pending, pendingSize);
+        Checksum padded = *this;
+        padded.mix(word);
+        return padded.hash;
+    }
+
+private:
+    void mix(const uchar *bytes)
+    {
+        quint64 word;
+        std::memcpy(&word, bytes, 8);
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+
+    quint64 hash = 14695981039346656037ull;
+    uchar pending[8];
+    int pendingSize = 0;
+};
+
+qint64 aligned(qint64 offset)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+void TableFile::setDirectory(const QString &directory)
+{
+    tableDirectory = directory;
+}
+
+QString TableFile::path(const QString &fileName)
+{
+    QString directory = tableDirectory;
+    if (directory.isEmpty()) {
+        directory = QCoreApplication::instance() ? QCoreApplication::applicationDirPath() : QDir::currentPath();
+    }
+    return QDir(directory).filePath(fileName);
+}
+
+TableFile::~TableFile()
+{
+    close();
+}
+
+void TableFile::close()
+{
+    if (verifier.joinable()) {
+        stopVerifying = true;
+        verifier.join();
+    }
+    if (data) {
+        file.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    file.close();
+    // Windows does not remove a file that is still open or mapped
+    if (damaged) {
+        QFile::remove(file.fileName());
+        damaged = false;
+    }
+}
+
+bool TableFile::open(const QString &path, quint32 version)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    size = file.size();
+    data = size >= qint64(sizeof(Header)) ? file.map(0, size) : nullptr;
+    if (!data) {
+        file.close();
+        return false;
+    }
+
+    // Only the header and the entries are read here, so opening takes the
+    // same time however large the tables are
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    qint64 entriesEnd = sizeof(Header) + qint64(header.tableCount) * qint64(sizeof(Entry));
+    bool valid = std::memcmp(header.magic, magic, sizeof(magic)) == 0
+            && header.formatVersion == formatVersion
+            && header.tableVersion == version
+            && entriesEnd <= size;
+    if (valid) {
+        Checksum sum;
+        sum.add(data + sizeof(Header), entriesEnd - qint64(sizeof(Header)));
+        valid = sum.value() == header.checksum;
+    }
+    for (quint32 i = 0; valid && i < header.tableCount; ++i) {
+        Entry entry;
+        std::memcpy(&entry, data + sizeof(Header) + i * sizeof(Entry), sizeof(entry));
+        valid = entry.offset >= quint64(entriesEnd) && entry.offset + entry.size <= quint64(size)
+                && entry.offset + entry.size >= entry.offset;
+    }
+    if (!valid) {
+        // Closed, so the rebuilt file can replace it
+        close();
+        return false;
+    }
+
+    stopVerifying = false;
+    verifier = std::thread(&TableFile::verifyTables, this);
+    return true;
+}
+
+void TableFile::verifyTables()
+{
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    for (quint32 i = 0; i < header.tableCount; ++i) {
+        Entry entry;
+        std::memcpy(&entry, data + sizeof(Header) + i * sizeof(Entry), sizeof(entry));
+        Checksum sum;
+        for (qint64 done = 0; done < qint64(entry.size); done += verifyChunk) {
+            if (stopVerifying) {
+                return;
+            }
+            sum.add(data + entry.offset + done, std::min(verifyChunk, qint64(entry.size) - done));
+        }
+        if (sum.value() != entry.checksum) {
+            // The mapping stays valid until close(), which removes the file
+            qWarning() << "Table" << QString::fromLatin1(entry.name)
+                       << "in" << file.fileName() << "is damaged";
+            damaged = true;
+            return;
+        }
+    }
+}
+
+const void *TableFile::table(const char *name, qint64 tableSize) const
+{
+    if (!data) {
+        return nullptr;
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    for (quint32 i = 0; i < header.tableCount; ++i) {
+        Entry entry;
+        std::memcpy(&entry, data + sizeof(Header) + i * sizeof(Entry), sizeof(entry));
+        if (std::strncmp(entry.name, name, sizeof(entry.name)) != 0) {
+            continue;
+        }
+        if (qint64(entry.size) != tableSize || qint64(entry.offset + entry.size) > size) {
+            return nullptr;
+        }
+        return data + entry.offset;
+    }
+    return nullptr;
+}
+
+bool TableFile::write(const QString &path, quint32 version, const std::vector<Table> &tables)
+{
+    Header header = {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.formatVersion = formatVersion;
+    header.tableVersion = version;
+    header.tableCount = quint32(tables.size());
+
+    std::vector<Entry> entries(tables.size());
+    qint64 offset = aligned(sizeof(Header) + tables.size() * sizeof(Entry));
+    for (size_t i = 0; i < tables.size(); ++i) {
+        Entry &entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        std::strncpy(entry.name, tables[i].name, sizeof(entry.name) - 1);
+        entry.offset = offset;
+        entry.size = tables[i].size;
+        Checksum tableSum;
+        tableSum.add(static_cast<const uchar *>(tables[i].data), tables[i].size);
+        entry.checksum = tableSum.value();
+        offset = aligned(offset + tables[i].size);
+    }
+
+    const qint64 entriesEnd = sizeof(Header) + qint64(entries.size() * sizeof(Entry));
+    Checksum sum;
+    sum.add(reinterpret_cast<const uchar *>(entries.data()), entries.size() * sizeof(Entry));
+    header.checksum = sum.value();
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    static const char zeros[alignment] = {};
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(Entry));
+    qint64 position = entriesEnd;
+    for (size_t i = 0; i < tables.size(); ++i) {
+        out.write(zeros, entries[i].offset - position);
+        out.write(static_cast<const char *>(tables[i].data), tables[i].size);
+        position = entries[i].offset + tables[i].size;
+    }
+    out.write(zeros, offset - position);
+    return out.commit();
+}
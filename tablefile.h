@@ -0,0 +1,123 @@
+#ifndef TABLEFILE_H
+#define TABLEFILE_H
+
+#include <QFile>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Binary file of named solver tables, memory-mapped read-only. The header
+// holds a format version, the version of the tables' layout and a checksum
+// over the table of contents; open() rejects files where any of them do
+// not match, so the caller rebuilds the tables and writes a new file.
+//
+// Every table has a checksum of its own as well. Checking those reads the
+// whole file, so open() leaves it to a thread of its own and the tables
+// can be used as soon as their pages fault in. Once a table fails the
+// check isDamaged() is true; the owner stops using the tables and builds
+// them again, and close() removes the damaged file.
+class TableFile
+{
+public:
+    TableFile() = default;
+    ~TableFile();
+    TableFile(const TableFile &) = delete;
+    TableFile &operator=(const TableFile &) = delete;
+
+    struct Table {
+        const char *name;
+        const void *data;
+        qint64 size;
+    };
+
+    // Where the table files live; the application's directory by default
+    static void setDirectory(const QString &directory);
+    static QString path(const QString &fileName);
+
+    bool open(const QString &path, quint32 version);
+
+    // Stops the check and unmaps the file, removing it if it is damaged.
+    // No table may be used after this.
+    void close();
+
+    bool isDamaged() const { return damaged.load(std::memory_order_relaxed); }
+
+    // Start of a table inside the mapping, nullptr if the file has no table
+    // of that name and size
+    const void *table(const char *name, qint64 size) const;
+
+    // Writes through a temporary file, so readers never see half a file
+    static bool write(const QString &path, quint32 version, const std::vector<Table> &tables);
+
+private:
+    void verifyTables();
+
+    QFile file;
+    const uchar *data = nullptr;
+    qint64 size = 0;
+
+    std::thread verifier;
+    std::atomic<bool> stopVerifying { false };
+    std::atomic<bool> damaged { false };
+};
+
+// Solver table that is either built in memory or points into a TableFile
+template <typename T>
+class SolverTable
+{
+public:
+    void resize(size_t count)
+    {
+        owned.resize(count);
+        entries = owned.data();
+        entryCount = count;
+    }
+
+    void assign(size_t count, T value)
+    {
+        owned.assign(count, value);
+        entries = owned.data();
+        entryCount = count;
+    }
+
+    void assign(std::vector<T> &&values)
+    {
+        owned = std::move(values);
+        entries = owned.data();
+        entryCount = owned.size();
+    }
+
+    bool map(const TableFile &file, const char *name, size_t count)
+    {
+        const void *mapped = file.table(name, qint64(count * sizeof(T)));
+        if (!mapped) {
+            return false;
+        }
+        owned.clear();
+        owned.shrink_to_fit();
+        entries = static_cast<const T *>(mapped);
+        entryCount = count;
+        return true;
+    }
+
+    TableFile::Table describe(const char *name) const
+    {
+        return { name, entries, qint64(entryCount * sizeof(T)) };
+    }
+
+    // Writing is only possible while the table is being built
+    T &operator[](size_t index) { return owned[index]; }
+    const T &operator[](size_t index) const { return entries[index]; }
+
+    size_t size() const { return entryCount; }
+
+private:
+    std::vector<T> owned;
+    const T *entries = nullptr;
+    size_t entryCount = 0;
+};
+
+#endif // TABLEFILE_H
@@ -0,0 +1,124 @@
+#include "transpositiontable.h"
+
+namespace {
+
+// Tag in the upper 40 bits, depth in the next 8, value in the low 16; an
+// entry of all zeros is free, so no tag is zero. The tag takes the hash
+// bits right above the ones that pick the bucket, so small tables tell
+// apart as many states as large ones.
+inline uint64_t tagOf(uint64_t hash, int bucketBits)
+{
+    uint64_t tag = hash >> bucketBits << 24;
+    return tag != 0 ? tag : uint64_t(1) << 24;
+}
+
+inline uint64_t pack(uint64_t tag, int depth, int value)
+{
+    return tag | uint64_t(depth & 0xff) << 16 | uint16_t(value);
+}
+
+inline int depthOf(uint64_t entry)
+{
+    return int(entry >> 16 & 0xff);
+}
+
+inline int valueOf(uint64_t entry)
+{
+    return int16_t(entry & 0xffff);
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+{
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= megabytes << 20) {
+        count *= 2;
+    }
+    buckets.reset(new Bucket[count]);
+    mask = count - 1;
+    bucketBits = 0;
+    while (size_t(1) << bucketBits < count) {
+        ++bucketBits;
+    }
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i <= mask; ++i) {
+        for (std::atomic<uint64_t> &entry : buckets[i].entries) {
+            entry.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TranspositionTable::find(uint64_t hash, Entry &entry) const
+{
+    const uint64_t tag = tagOf(hash, bucketBits);
+    for (const std::atomic<uint64_t> &slot : bucket(hash).entries) {
+        uint64_t stored = slot.load(std::memory_order_relaxed);
+        if ((stored & ~uint64_t(0xffffff)) == tag) {
+            entry.depth = depthOf(stored);
+            entry.value = valueOf(stored);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TranspositionTable::insertIfAbsent(uint64_t hash, int depth, int value)
+{
+    return insert(hash, depth, value, false);
+}
+
+void TranspositionTable::store(uint64_t hash, int depth, int value)
+{
+    insert(hash, depth, value, true);
+}
+
+bool TranspositionTable::insert(uint64_t hash, int depth, int value, bool replaceSame)
+{
+    const uint64_t tag = tagOf(hash, bucketBits);
+    const uint64_t entry = pack(tag, depth, value);
+    Bucket &target = bucket(hash);
+
+    // A failed compare-and-swap means another thread changed the bucket
+    // meanwhile, so look at it again from the start
+    for (;;) {
+        std::atomic<uint64_t> *victim = nullptr;
+        uint64_t victimEntry = 0;
+        int victimDepth = 256;
+        bool retry = false;
+        for (std::atomic<uint64_t> &slot : target.entries) {
+            uint64_t stored = slot.load(std::memory_order_relaxed);
+            if ((stored & ~uint64_t(0xffffff)) == tag) {
+                if (!replaceSame || depthOf(stored) > depth || stored == entry) {
+                    return false;
+                }
+                if (slot.compare_exchange_weak(stored, entry, std::memory_order_relaxed)) {
+                    return false;
+                }
+                retry = true;
+                break;
+            }
+            int storedDepth = stored == 0 ? -1 : depthOf(stored);
+            if (storedDepth < victimDepth) {
+                victim = &slot;
+                victimEntry = stored;
+                victimDepth = storedDepth;
+            }
+        }
+        if (retry) {
+            continue;
+        }
+        // Free entries come first, then ones of less depth; store() also
+        // pushes out an entry of the same depth, which is likely older
+        if (victimDepth > depth || (victimDepth == depth && !replaceSame)) {
+            return true;
+        }
+        if (victim->compare_exchange_weak(victimEntry, entry, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
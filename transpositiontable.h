@@ -0,0 +1,65 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fixed-size hash table of 64-bit state hashes that any number of threads
+// can read and write without locks, for transpositions in a search and
+// duplicates in a breadth-first walk.
+//
+// An entry is one 64-bit word: 40 bits of the hash, a depth and a 16-bit
+// value, changed with a single compare-and-swap. Eight entries make a
+// bucket of one cache line, picked by the low bits of the hash; the 40
+// bits are the ones above those.
+// When a bucket is full the entry of least depth gives way, so depth
+// should grow with what an entry is worth keeping, e.g. the search depth
+// left below it. Two threads adding the same hash at the same moment may
+// both see it as new. Keyed by canonicalHash(), one entry stands for all
+// the states that are the same up to symmetry.
+class TranspositionTable
+{
+public:
+    struct Entry {
+        int depth;      // 0..255
+        int value;      // -32768..32767
+    };
+
+    // Rounded down to a power of two buckets, at least one
+    explicit TranspositionTable(size_t megabytes);
+
+    size_t bucketCount() const { return mask + 1; }
+
+    // Not while other threads use the table
+    void clear();
+
+    bool find(uint64_t hash, Entry &entry) const;
+
+    // Adds the hash unless it is in the table already. Returns whether it
+    // was new; a new hash is only kept if it finds a free entry or one of
+    // less depth.
+    bool insertIfAbsent(uint64_t hash, int depth, int value);
+
+    // Adds the hash, or updates its entry unless that has more depth. A new
+    // hash may also push out an entry of the same depth.
+    void store(uint64_t hash, int depth, int value);
+
+    static constexpr int bucketSize = 8;
+
+private:
+    struct alignas(64) Bucket {
+        std::atomic<uint64_t> entries[bucketSize];
+    };
+
+    Bucket &bucket(uint64_t hash) const { return buckets[hash & mask]; }
+
+    bool insert(uint64_t hash, int depth, int value, bool replaceSame);
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t mask;
+    int bucketBits;     // log2 of the bucket count
+};
+
+#endif // TRANSPOSITIONTABLE_H
@@ -0,0 +1,567 @@
+#include "twophasesolver.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+#include "cubiecube.h"
+
+const char TwoPhaseSolver::tableFileName[] = "twophase.tables";
+
+const uint8_t TwoPhaseSolver::phase2Moves[phase2MoveCount] = {
+    MoveU, MoveU2, MoveUPrime, MoveR2, MoveF2, MoveD, MoveD2, MoveDPrime, MoveL2, MoveB2
+};
+
+namespace {
+
+// Bump whenever the layout of any table changes
+constexpr quint32 tableVersion = 1;
+
+// Fills a pruning table by breadth-first search from the solved entry.
+// next(index, move) returns the neighbouring index.
+template <typename Next>
+void buildPruningTable(SolverTable<uint8_t> &table, int size, int moveCount, Next next)
+{
+    table.assign(size, 0xff);
+    std::vector<int> frontier = { 0 };
+    std::vector<int> nextFrontier;
+    table[0] = 0;
+    for (uint8_t depth = 1; !frontier.empty(); ++depth) {
+        nextFrontier.clear();
+        for (int index : frontier) {
+            for (int move = 0; move < moveCount; ++move) {
+                int neighbour = next(index, move);
+                if (table[neighbour] == 0xff) {
+                    table[neighbour] = depth;
+                    nextFrontier.push_back(neighbour);
+                }
+            }
+        }
+        frontier.swap(nextFrontier);
+    }
+}
+
+bool sameAxisBlocked(int face, int lastFace)
+{
+    // No two turns of the same face in a row, opposite faces only in URF order
+    return face == lastFace || face == lastFace - 3;
+}
+
+} // namespace
+
+TwoPhaseSolver &TwoPhaseSolver::mutableInstance()
+{
+    static TwoPhaseSolver solver;
+    return solver;
+}
+
+const TwoPhaseSolver &TwoPhaseSolver::instance()
+{
+    return mutableInstance();
+}
+
+void TwoPhaseSolver::repairTables()
+{
+    TwoPhaseSolver &solver = mutableInstance();
+    if (!solver.tablesDamaged()) {
+        return;
+    }
+    // Removes the damaged file, the new one takes its place
+    solver.tableFile.close();
+    solver.buildTables();
+}
+
+TwoPhaseSolver::TwoPhaseSolver()
+{
+    if (!loadTables()) {
+        buildTables();
+    }
+}
+
+void TwoPhaseSolver::buildTables()
+{
+    initMoveTables();
+    initSymmetryTables();
+    initPruningTables();
+    saveTables();
+}
+
+bool TwoPhaseSolver::loadTables()
+{
+    if (!tableFile.open(TableFile::path(tableFileName), tableVersion)) {
+        return false;
+    }
+    bool mapped = twistMove.map(tableFile, "twistMove", twistCount * faceTurnCount)
+        && flipMove.map(tableFile, "flipMove", flipCount * faceTurnCount)
+        && sliceSortedMove.map(tableFile, "sliceSortedMove", sliceSortedCount * faceTurnCount)
+        && cornerPermMove.map(tableFile, "cornerPermMove", cornerPermCount * faceTurnCount)
+        && edgePermMove.map(tableFile, "edgePermMove", edgePermCount * phase2MoveCount)
+        && slicePermMove.map(tableFile, "slicePermMove", slicePermCount * phase2MoveCount)
+        && flipSliceClass.map(tableFile, "flipSliceClass", flipSliceCount)
+        && flipSliceSym.map(tableFile, "flipSliceSym", flipSliceCount)
+        && flipSliceRep.map(tableFile, "flipSliceRep", flipSliceClassCount)
+        && flipSliceSelfSyms.map(tableFile, "flipSliceSelfSyms", flipSliceClassCount)
+        && twistConj.map(tableFile, "twistConj", twistCount * symmetryCountUD)
+        && phase1Prune.map(tableFile, "phase1Prune", (flipSliceClassCount * twistCount + 15) / 16)
+        && cornerSlicePrune.map(tableFile, "cornerSlicePrune", cornerPermCount * slicePermCount)
+        && edgeSlicePrune.map(tableFile, "edgeSlicePrune", edgePermCount * slicePermCount);
+    if (!mapped) {
+        tableFile.close();
+    }
+    return mapped;
+}
+
+bool TwoPhaseSolver::saveTables() const
+{
+    return TableFile::write(TableFile::path(tableFileName), tableVersion, {
+        twistMove.describe("twistMove"),
+        flipMove.describe("flipMove"),
+        sliceSortedMove.describe("sliceSortedMove"),
+        cornerPermMove.describe("cornerPermMove"),
+        edgePermMove.describe("edgePermMove"),
+        slicePermMove.describe("slicePermMove"),
+        flipSliceClass.describe("flipSliceClass"),
+        flipSliceSym.describe("flipSliceSym"),
+        flipSliceRep.describe("flipSliceRep"),
+        flipSliceSelfSyms.describe("flipSliceSelfSyms"),
+        twistConj.describe("twistConj"),
+        phase1Prune.describe("phase1Prune"),
+        cornerSlicePrune.describe("cornerSlicePrune"),
+        edgeSlicePrune.describe("edgeSlicePrune")
+    });
+}
+
+void TwoPhaseSolver::initMoveTables()
+{
+    twistMove.resize(twistCount * faceTurnCount);
+    flipMove.resize(flipCount * faceTurnCount);
+    sliceSortedMove.resize(sliceSortedCount * faceTurnCount);
+    cornerPermMove.resize(cornerPermCount * faceTurnCount);
+    edgePermMove.resize(edgePermCount * phase2MoveCount);
+    slicePermMove.resize(slicePermCount * phase2MoveCount);
+
+    CubieCube cube;
+    for (int i = 0; i < twistCount; ++i) {
+        for (int move = 0; move < faceTurnCount; ++move) {
+            cube.setTwist(i);
+            cube.turn(move);
+            twistMove[i * faceTurnCount + move] = cube.twist();
+        }
+    }
+    for (int i = 0; i < flipCount; ++i) {
+        for (int move = 0; move < faceTurnCount; ++move) {
+            cube.setFlip(i);
+            cube.turn(move);
+            flipMove[i * faceTurnCount + move] = cube.flip();
+        }
+    }
+    for (int i = 0; i < sliceSortedCount; ++i) {
+        for (int move = 0; move < faceTurnCount; ++move) {
+            cube.setSliceSorted(i);
+            cube.turn(move);
+            sliceSortedMove[i * faceTurnCount + move] = cube.sliceSorted();
+        }
+    }
+    for (int i = 0; i < cornerPermCount; ++i) {
+        for (int move = 0; move < faceTurnCount; ++move) {
+            cube.setCornerPerm(i);
+            cube.turn(move);
+            cornerPermMove[i * faceTurnCount + move] = cube.cornerPerm();
+        }
+    }
+
+    for (int i = 0; i < edgePermCount; ++i) {
+        for (int move = 0; move < phase2MoveCount; ++move) {
+            cube = CubieCube();
+            cube.setEdgePerm(i);
+            cube.turn(phase2Moves[move]);
+            edgePermMove[i * phase2MoveCount + move] = cube.edgePerm();
+        }
+    }
+    for (int i = 0; i < slicePermCount; ++i) {
+        for (int move = 0; move < phase2MoveCount; ++move) {
+            cube = CubieCube();
+            cube.setSlicePerm(i);
+            cube.turn(phase2Moves[move]);
+            slicePermMove[i * phase2MoveCount + move] = cube.slicePerm();
+        }
+    }
+}
+
+void TwoPhaseSolver::initSymmetryTables()
+{
+    flipSliceClass.assign(flipSliceCount, 0xffff);
+    flipSliceSym.resize(flipSliceCount);
+    std::vector<uint32_t> reps;
+    std::vector<uint16_t> selfSymsOfClass;
+    reps.reserve(flipSliceClassCount);
+    selfSymsOfClass.reserve(flipSliceClassCount);
+
+    CubieCube cube;
+    for (int index = 0; index < flipSliceCount; ++index) {
+        if (flipSliceClass[index] != 0xffff) {
+            continue;
+        }
+        // The smallest flip-slice of every class is its representative
+        cube.setSlice(index / flipCount);
+        cube.setFlip(index % flipCount);
+        uint16_t selfSyms = 0;
+        for (int sym = 0; sym < symmetryCountUD; ++sym) {
+            CubieCube other = conjugate(cube, symmetryInverse(sym));
+            int otherIndex = other.slice() * flipCount + other.flip();
+            if (otherIndex == index) {
+                selfSyms |= 1 << sym;
+            }
+            if (flipSliceClass[otherIndex] == 0xffff) {
+                flipSliceClass[otherIndex] = uint16_t(reps.size());
+                flipSliceSym[otherIndex] = sym;
+            }
+        }
+        reps.push_back(index);
+        selfSymsOfClass.push_back(selfSyms);
+    }
+    assert(reps.size() == flipSliceClassCount);
+    flipSliceRep.assign(std::move(reps));
+    flipSliceSelfSyms.assign(std::move(selfSymsOfClass));
+
+    twistConj.resize(twistCount * symmetryCountUD);
+    cube = CubieCube();
+    for (int twist = 0; twist < twistCount; ++twist) {
+        cube.setTwist(twist);
+        for (int sym = 0; sym < symmetryCountUD; ++sym) {
+            twistConj[twist * symmetryCountUD + sym] = conjugate(cube, sym).twist();
+        }
+    }
+}
+
+void TwoPhaseSolver::initPruningTables()
+{
+    initPhase1Table();
+    buildPruningTable(cornerSlicePrune, cornerPermCount * slicePermCount, phase2MoveCount, [this](int index, int move) {
+        int corners = cornerPermMove[(index / slicePermCount) * faceTurnCount + phase2Moves[move]];
+        int slice = slicePermMove[(index % slicePermCount) * phase2MoveCount + move];
+        return corners * slicePermCount + slice;
+    });
+    buildPruningTable(edgeSlicePrune, edgePermCount * slicePermCount, phase2MoveCount, [this](int index, int move) {
+        int edges = edgePermMove[(index / slicePermCount) * phase2MoveCount + move];
+        int slice = slicePermMove[(index % slicePermCount) * phase2MoveCount + move];
+        return edges * slicePermCount + slice;
+    });
+}
+
+int TwoPhaseSolver::phase1Index(int twist, int flip, int slice) const
+{
+    int flipSlice = slice * flipCount + flip;
+    int sym = flipSliceSym[flipSlice];
+    return flipSliceClass[flipSlice] * twistCount + twistConj[twist * symmetryCountUD + sym];
+}
+
+int TwoPhaseSolver::phase1Mod3(int index) const
+{
+    return (phase1Prune[index >> 4] >> ((index & 15) * 2)) & 3;
+}
+
+void TwoPhaseSolver::initPhase1Table()
+{
+    const int size = flipSliceClassCount * twistCount;
+    // 3 marks entries that are not reached yet
+    phase1Prune.assign((size + 15) / 16, 0xffffffff);
+    auto set = [this](int index, int mod3) {
+        phase1Prune[index >> 4] &= ~(3u << ((index & 15) * 2));
+        phase1Prune[index >> 4] |= uint32_t(mod3) << ((index & 15) * 2);
+    };
+    set(0, 0);
+
+    int done = 1;
+    for (int depth = 0; done < size; ++depth) {
+        int mod3 = depth % 3;
+        int nextMod3 = (depth + 1) % 3;
+        // Once most entries are known it is cheaper to look from the
+        // unknown ones for a neighbour at the current depth
+        bool backwards = depth >= 9;
+        for (int index = 0; index < size; ++index) {
+            if (!backwards && phase1Prune[index >> 4] == 0xffffffff) {
+                index |= 15;
+                continue;
+            }
+            int entry = phase1Mod3(index);
+            if (entry != (backwards ? 3 : mod3)) {
+                continue;
+            }
+            int rep = flipSliceRep[index / twistCount];
+            int flip = rep % flipCount;
+            int slice = rep / flipCount;
+            int twist = index % twistCount;
+            for (int move = 0; move < faceTurnCount; ++move) {
+                int neighbour = phase1Index(twistMove[twist * faceTurnCount + move],
+                                            flipMove[flip * faceTurnCount + move],
+                                            sliceSortedMove[slice * slicePermCount * faceTurnCount + move] / slicePermCount);
+                if (backwards) {
+                    if (phase1Mod3(neighbour) == mod3) {
+                        set(index, nextMod3);
+                        ++done;
+                        break;
+                    }
+                    continue;
+                }
+                if (phase1Mod3(neighbour) != 3) {
+                    continue;
+                }
+                set(neighbour, nextMod3);
+                ++done;
+                // Entries of a symmetric representative that are the same state
+                int classIndex = neighbour / twistCount;
+                int neighbourTwist = neighbour % twistCount;
+                for (int sym = 1, syms = flipSliceSelfSyms[classIndex] >> 1; syms; ++sym, syms >>= 1) {
+                    if (!(syms & 1)) {
+                        continue;
+                    }
+                    int same = classIndex * twistCount + twistConj[neighbourTwist * symmetryCountUD + sym];
+                    if (phase1Mod3(same) == 3) {
+                        set(same, nextMod3);
+                        ++done;
+                    }
+                }
+            }
+        }
+    }
+}
+
+int TwoPhaseSolver::phase1Distance(int twist, int flip, int slice) const
+{
+    // Walk down to the goal along moves that lower the distance mod 3
+    int distance = 0;
+    int mod3 = phase1Mod3(phase1Index(twist, flip, slice));
+    while (twist != 0 || flip != 0 || slice != 0) {
+        int lower = (mod3 + 2) % 3;
+        for (int move = 0; move < faceTurnCount; ++move) {
+            int nextTwist = twistMove[twist * faceTurnCount + move];
+            int nextFlip = flipMove[flip * faceTurnCount + move];
+            int nextSlice = sliceSortedMove[slice * slicePermCount * faceTurnCount + move] / slicePermCount;
+            if (phase1Mod3(phase1Index(nextTwist, nextFlip, nextSlice)) == lower) {
+                twist = nextTwist;
+                flip = nextFlip;
+                slice = nextSlice;
+                mod3 = lower;
+                ++distance;
+                break;
+            }
+        }
+    }
+    return distance;
+}
+
+// State of one solve() call
+class TwoPhaseSearch
+{
+public:
+    TwoPhaseSearch(const TwoPhaseSolver &solver, const CubeState &state, int maxLength,
+                   std::chrono::steady_clock::time_point deadline,
+                   const TwoPhaseSolver::Improved &improved, const std::atomic<bool> *cancel,
+                   bool settleForFirst = false)
+        : tables(solver)
+        , start(state)
+        , targetLength(maxLength)
+        , deadline(deadline)
+        , improved(improved)
+        , cancel(cancel)
+        , settleForFirst(settleForFirst)
+    {}
+
+    std::vector<Move> run();
+
+private:
+    struct Phase1Node {
+        int twist;
+        int flip;
+        int sliceSorted;
+        int corners;
+        int distance;   // exact phase 1 distance
+    };
+
+    bool phase1(const Phase1Node &node, int depth, int togo);
+    bool startPhase2(const Phase1Node &node, int depth);
+    bool phase2(int corners, int edges, int slice, int depth, int togo);
+    int phase2Estimate(int corners, int edges, int slice) const;
+    bool timedOut();
+
+    const TwoPhaseSolver &tables;
+    CubieCube start;
+    int targetLength;
+    std::chrono::steady_clock::time_point deadline;
+    const TwoPhaseSolver::Improved &improved;
+    const std::atomic<bool> *cancel;
+    bool settleForFirst;    // go past the deadline until there is a solution
+
+    Move path[40];
+    int bestLength = 31;
+    std::vector<Move> best;
+    bool stopped = false;
+    unsigned nodes = 0;
+};
+
+std::vector<Move> TwoPhaseSearch::run()
+{
+    Phase1Node root = { start.twist(), start.flip(), start.sliceSorted(), start.cornerPerm(), 0 };
+    root.distance = tables.phase1Distance(root.twist, root.flip, root.sliceSorted / TwoPhaseSolver::slicePermCount);
+    for (int depth = root.distance; depth < bestLength && !stopped; ++depth) {
+        if (phase1(root, 0, depth)) {
+            break;
+        }
+    }
+    return best;
+}
+
+int TwoPhaseSearch::phase2Estimate(int corners, int edges, int slice) const
+{
+    return std::max(tables.cornerSlicePrune[corners * TwoPhaseSolver::slicePermCount + slice],
+                    tables.edgeSlicePrune[edges * TwoPhaseSolver::slicePermCount + slice]);
+}
+
+// Returns true once a short enough solution is found or the time is up
+bool TwoPhaseSearch::phase1(const Phase1Node &node, int depth, int togo)
+{
+    if (togo == 0) {
+        // A phase 1 solution ending in a phase 2 move was already tried one move shorter
+        if (depth > 0) {
+            int last = path[depth - 1];
+            if (last / 3 == FaceU || last / 3 == FaceD || last % 3 == 1) {
+                return false;
+            }
+        }
+        return startPhase2(node, depth);
+    }
+
+    if (timedOut()) {
+        return true;
+    }
+
+    int lastFace = depth > 0 ? path[depth - 1] / 3 : -1;
+    for (int move = 0; move < faceTurnCount; ++move) {
+        if (sameAxisBlocked(move / 3, lastFace)) {
+            continue;
+        }
+        Phase1Node next = {
+            tables.twistMove[node.twist * faceTurnCount + move],
+            tables.flipMove[node.flip * faceTurnCount + move],
+            tables.sliceSortedMove[node.sliceSorted * faceTurnCount + move],
+            tables.cornerPermMove[node.corners * faceTurnCount + move],
+            0
+        };
+        int mod3 = tables.phase1Mod3(tables.phase1Index(next.twist, next.flip, next.sliceSorted / TwoPhaseSolver::slicePermCount));
+        int change = (mod3 - node.distance % 3 + 3) % 3;
+        next.distance = node.distance + (change == 2 ? -1 : change);
+        if (next.distance >= togo) {
+            continue;
+        }
+        path[depth] = Move(move);
+        if (phase1(next, depth + 1, togo - 1)) {
+            return true;
+        }
+        if (depth + togo >= bestLength) {
+            // A shorter solution was found below, this depth is no longer useful
+            return false;
+        }
+    }
+    return false;
+}
+
+bool TwoPhaseSearch::startPhase2(const Phase1Node &node, int depth)
+{
+    int maxDepth = std::min(bestLength - 1 - depth, 18);
+    int corners = node.corners;
+    int slice = node.sliceSorted;
+    if (tables.cornerSlicePrune[corners * TwoPhaseSolver::slicePermCount + slice] > maxDepth) {
+        return false;
+    }
+
+    CubieCube cube = start;
+    for (int i = 0; i < depth; ++i) {
+        cube.turn(path[i]);
+    }
+    int edges = cube.edgePerm();
+
+    for (int togo = phase2Estimate(corners, edges, slice); togo <= maxDepth && !stopped; ++togo) {
+        if (phase2(corners, edges, slice, depth, togo)) {
+            int length = depth + togo;
+            bestLength = length;
+            best.assign(path, path + length);
+            if (improved) {
+                improved(best);
+            }
+            return length <= targetLength;
+        }
+    }
+    return false;
+}
+
+bool TwoPhaseSearch::phase2(int corners, int edges, int slice, int depth, int togo)
+{
+    if (togo == 0) {
+        return corners == 0 && edges == 0 && slice == 0;
+    }
+    if (timedOut()) {
+        return false;
+    }
+
+    int lastFace = depth > 0 ? path[depth - 1] / 3 : -1;
+    for (int i = 0; i < TwoPhaseSolver::phase2MoveCount; ++i) {
+        int move = TwoPhaseSolver::phase2Moves[i];
+        if (sameAxisBlocked(move / 3, lastFace)) {
+            continue;
+        }
+        int newCorners = tables.cornerPermMove[corners * faceTurnCount + move];
+        int newEdges = tables.edgePermMove[edges * TwoPhaseSolver::phase2MoveCount + i];
+        int newSlice = tables.slicePermMove[slice * TwoPhaseSolver::phase2MoveCount + i];
+        if (phase2Estimate(newCorners, newEdges, newSlice) >= togo) {
+            continue;
+        }
+        path[depth] = Move(move);
+        if (phase2(newCorners, newEdges, newSlice, depth + 1, togo - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TwoPhaseSearch::timedOut()
+{
+    if (stopped) {
+        return true;
+    }
+    // Reading the clock is slow compared to a node, look at it now and then
+    if ((++nodes & 0x3ff) == 0) {
+        if ((cancel && cancel->load(std::memory_order_relaxed)) || tables.tablesDamaged()) {
+            stopped = true;
+        } else if (std::chrono::steady_clock::now() > deadline) {
+            stopped = !settleForFirst || !best.empty();
+            if (!stopped) {
+                // Without any solution yet, settle for the first one
+                targetLength = 30;
+            }
+        }
+    }
+    return stopped;
+}
+
+std::vector<Move> TwoPhaseSolver::solve(const CubeState &state, int maxLength, int timeoutMs) const
+{
+    if (state.isSolved() || tablesDamaged()) {
+        return {};
+    }
+    const Improved none;
+    TwoPhaseSearch search(*this, state, maxLength, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs),
+                          none, nullptr, true);
+    return search.run();
+}
+
+std::vector<Move> TwoPhaseSolver::solve(const CubeState &state, std::chrono::steady_clock::time_point deadline,
+                                        const Improved &improved, const std::atomic<bool> *cancel,
+                                        int maxLength) const
+{
+    if (state.isSolved() || tablesDamaged()) {
+        return {};
+    }
+    TwoPhaseSearch search(*this, state, maxLength, deadline, improved, cancel);
+    return search.run();
+}
@@ -0,0 +1,121 @@
+#ifndef TWOPHASESOLVER_H
+#define TWOPHASESOLVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "cubestate.h"
+#include "tablefile.h"
+
+// Kociemba's two-phase algorithm.
+//
+// Phase 1 brings the cube into the subgroup <U, D, R2, L2, F2, B2> (no
+// twisted corners, no flipped edges, the E-slice edges in the E slice),
+// phase 2 solves it inside that subgroup. Both phases are IDA* searches on
+// coordinate move tables with pruning tables as heuristics. Phase 1 uses
+// the exact distance over twist, flip and slice, made small enough by the
+// 16 symmetries that keep the U-D axis. The tables are mapped from
+// tableFileName, or built and written there when that file is missing or
+// stale; after that solve() is reentrant.
+class TwoPhaseSolver
+{
+public:
+    static const TwoPhaseSolver &instance();
+
+    // True once the background check of the table file found it damaged.
+    // Solves then return at once, empty, until repairTables() has built
+    // the tables again; that must not run alongside any solve.
+    bool tablesDamaged() const { return tableFile.isDamaged(); }
+    static void repairTables();
+
+    static const char tableFileName[];
+
+    // Face turns in the centers' frame that solve the state. Keeps looking
+    // for shorter solutions until one has at most maxLength moves or the
+    // time runs out, then returns the shortest found. Without any solution
+    // at that point it goes on to the first one, which takes a few ms, so
+    // the result is only empty for a solved state or damaged tables.
+    std::vector<Move> solve(const CubeState &state, int maxLength = 20, int timeoutMs = 1000) const;
+
+    typedef std::function<void(const std::vector<Move> &solution)> Improved;
+
+    // Anytime solve: calls improved, on the searching thread, with every
+    // solution shorter than the ones before, and returns the shortest at
+    // the deadline, once *cancel is set or once one has at most maxLength
+    // moves. The deadline holds even before the first solution, which
+    // takes a few ms, so the result may be empty. The clock and the flag
+    // are looked at every 1024 nodes, well below a millisecond.
+    std::vector<Move> solve(const CubeState &state, std::chrono::steady_clock::time_point deadline,
+                            const Improved &improved, const std::atomic<bool> *cancel = nullptr,
+                            int maxLength = 0) const;
+
+    // Coordinate sizes
+    static constexpr int twistCount = 2187;         // 3^7 corner orientations
+    static constexpr int flipCount = 2048;          // 2^11 edge orientations
+    static constexpr int sliceCount = 495;          // 12 choose 4 E-slice positions
+    static constexpr int sliceSortedCount = 11880;  // positions and order of the E-slice edges
+    static constexpr int cornerPermCount = 40320;   // 8!
+    static constexpr int edgePermCount = 40320;     // 8! U and D edge permutations
+    static constexpr int slicePermCount = 24;       // 4!
+    static constexpr int flipSliceCount = flipCount * sliceCount;
+    static constexpr int flipSliceClassCount = 64430;
+
+    static constexpr int phase2MoveCount = 10;
+    static const uint8_t phase2Moves[phase2MoveCount];
+
+private:
+    TwoPhaseSolver();
+
+    friend class TwoPhaseSearch;
+
+    static TwoPhaseSolver &mutableInstance();
+
+    void buildTables();
+    void initMoveTables();
+    bool loadTables();
+    bool saveTables() const;
+
+    void initSymmetryTables();
+    void initPruningTables();
+    void initPhase1Table();
+
+    int phase1Index(int twist, int flip, int slice) const;
+    int phase1Mod3(int index) const;
+    int phase1Distance(int twist, int flip, int slice) const;
+
+    // Move tables, indexed [coordinate * 18 + move]. The corner permutation
+    // and the sorted slice are followed through phase 1 so that most phase 2
+    // starts can be rejected before building the cube.
+    SolverTable<uint16_t> twistMove;
+    SolverTable<uint16_t> flipMove;
+    SolverTable<uint16_t> sliceSortedMove;
+    SolverTable<uint16_t> cornerPermMove;
+
+    // Phase 2 move tables, indexed [coordinate * 10 + phase 2 move]
+    SolverTable<uint16_t> edgePermMove;
+    SolverTable<uint8_t> slicePermMove;
+
+    // Flip-slice (slice * 2048 + flip) classes under the U-D symmetries.
+    // Conjugating by flipSliceSym maps a flip-slice to its representative.
+    SolverTable<uint16_t> flipSliceClass;
+    SolverTable<uint8_t> flipSliceSym;
+    SolverTable<uint32_t> flipSliceRep;
+    SolverTable<uint16_t> flipSliceSelfSyms;    // symmetries that fix the representative
+    SolverTable<uint16_t> twistConj;            // twist * 16 + symmetry
+
+    // Phase 1 distance mod 3 at two bits per class * 2187 + conjugated twist;
+    // the exact distance follows from the parent's since a move changes it
+    // by at most one
+    SolverTable<uint32_t> phase1Prune;
+
+    // Phase 2 distance ignoring one of the permutations
+    SolverTable<uint8_t> cornerSlicePrune;      // corner perm * 24 + slice perm
+    SolverTable<uint8_t> edgeSlicePrune;        // edge perm * 24 + slice perm
+
+    TableFile tableFile;
+};
+
+#endif // TWOPHASESOLVER_H
@@ -1,10 +1,24 @@
 #version 330 core
-layout (location = 0) in vec4 a_pos;
-layout (location = 1) in vec3 a_color;
+layout (location = 0) in vec3 a_pos;
+layout (location = 1) in float a_face;
+// Per instance
+layout (location = 2) in mat4 a_model;
+layout (location = 6) in vec3 a_color0;
+layout (location = 7) in vec3 a_color1;
+layout (location = 8) in vec3 a_color2;
+layout (location = 9) in vec3 a_color3;
+layout (location = 10) in vec3 a_color4;
+layout (location = 11) in vec3 a_color5;
 out vec3 our_color;
-uniform mat4 mvp_matrix;
+uniform mat4 vp_matrix;
 void main()
 {
-   gl_Position = mvp_matrix * a_pos;
-   our_color = a_color;
+   gl_Position = vp_matrix * a_model * vec4(a_pos, 1.0);
+   int face = int(a_face + 0.5);
+   if (face == 0) our_color = a_color0;
+   else if (face == 1) our_color = a_color1;
+   else if (face == 2) our_color = a_color2;
+   else if (face == 3) our_color = a_color3;
+   else if (face == 4) our_color = a_color4;
+   else our_color = a_color5;
 };
@@ -0,0 +1,100 @@
+#include "workstealingpool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+{
+    if (threadCount <= 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        workers[i]->thread = std::thread(&WorkStealingPool::work, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    started.notify_all();
+    for (auto &worker : workers) {
+        worker->thread.join();
+    }
+}
+
+void WorkStealingPool::run(std::vector<Task> tasks)
+{
+    if (tasks.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        remaining = tasks.size();
+    }
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        Worker &worker = *workers[i % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(std::move(tasks[i]));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++round;
+    }
+    started.notify_all();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return remaining == 0; });
+}
+
+void WorkStealingPool::work(int index)
+{
+    unsigned seenRound = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            started.wait(lock, [&]() { return quitting || round != seenRound; });
+            if (quitting) {
+                return;
+            }
+            seenRound = round;
+        }
+
+        Task task;
+        while (takeTask(index, task)) {
+            task(index);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0) {
+                finished.notify_all();
+            }
+        }
+    }
+}
+
+bool WorkStealingPool::takeTask(int index, Task &task)
+{
+    {
+        Worker &own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.queue.empty()) {
+            task = std::move(own.queue.front());
+            own.queue.pop_front();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers.size(); ++i) {
+        Worker &victim = *workers[(index + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty()) {
+            task = std::move(victim.queue.back());
+            victim.queue.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
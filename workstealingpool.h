@@ -0,0 +1,51 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task queue each. run() deals the
+// tasks round-robin; a worker takes from the front of its own queue and,
+// once that is empty, steals from the back of the others', so uneven
+// tasks still keep every core busy. One run() at a time.
+class WorkStealingPool
+{
+public:
+    // The argument is the index of the worker that runs the task
+    typedef std::function<void(int)> Task;
+
+    // 0 threads means one per core
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    int threadCount() const { return int(workers.size()); }
+
+    // Returns once all tasks have run
+    void run(std::vector<Task> tasks);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> queue;
+        std::thread thread;
+    };
+
+    void work(int index);
+    bool takeTask(int index, Task &task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    unsigned round = 0;
+    size_t remaining = 0;
+    bool quitting = false;
+};
+
+#endif // WORKSTEALINGPOOL_H